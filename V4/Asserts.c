@@ -177,7 +177,7 @@ int Asserts_LoadAsserts() {
 			rc=0;
 	}
 	else
-		rc=sscanf(value,"%d",&a.value);
+		rc=sscanf(value,MEMORYCELLFORMAT,&a.value);
 
     if (rc==0){
  			// printf("Illegal expected value format in line %d of file %s (%s)\n",lineNumber,ASSERTS_FILE,value);
@@ -229,7 +229,7 @@ int Asserts_LoadAsserts() {
 }
 
 
-void genAssertMsg(int time, char *ele, int realValue, int addr) {
+void genAssertMsg(int time, char *ele, MEMORYCELL realValue, int addr) {
 	int en;
 
 	printf("%d, %s",time, ele);
@@ -238,7 +238,7 @@ void genAssertMsg(int time, char *ele, int realValue, int addr) {
 	if ((en==RMEM_OP) || (en==AMEM_OP) || (en==IR_OP) || (en==MBR_OP)) 
 	  	printf(", %s",InstructionNames[realValue]);
 	else
-		printf(", %d", realValue);
+		printf(", " MEMORYCELLFORMAT, realValue);
 	
 	if ((en==RMEM_OP) || (en==RMEM_O1) || (en==RMEM_O2)
 		 || (en==AMEM_OP) || (en==AMEM_O1) || (en==AMEM_O2) 
@@ -249,8 +249,9 @@ void genAssertMsg(int time, char *ele, int realValue, int addr) {
 	printf("\n");
 }
 	
-void assertMsg(int time, char *ele, int expectedValue, int realValue, int addr) {
+void assertMsg(int time, char *ele, MEMORYCELL expectedValue, MEMORYCELL realValue, int addr) {
 	int en;
+	char expected[MAXIMUMLENGTH], real[MAXIMUMLENGTH];
 
 	if (GEN_ASSERTS) { 
 		genAssertMsg(time, ele, realValue,addr);
@@ -264,9 +265,13 @@ void assertMsg(int time, char *ele, int expectedValue, int realValue, int addr)
 	if ((en==RMEM_OP) || (en==AMEM_OP) || (en==IR_OP) || (en==MBR_OP)) 
 	  	// printf("Expected: '%s'; Real: '%s'", expectedValue, realValue);
 	  	ComputerSystem_DebugMessage(89,ERROR, InstructionNames[expectedValue], InstructionNames[realValue]);
-	else
+	else {
 		// printf("Expected: %d; Real: %d", expectedValue, realValue);
-		ComputerSystem_DebugMessage(90,ERROR, expectedValue, realValue);
+		// Message 90 only prints int values, so whole cells are printed as text
+		snprintf(expected, MAXIMUMLENGTH, MEMORYCELLFORMAT, expectedValue);
+		snprintf(real, MAXIMUMLENGTH, MEMORYCELLFORMAT, realValue);
+		ComputerSystem_DebugMessage(89,ERROR, expected, real);
+	}
 	
 	if ((en==RMEM_OP) || (en==RMEM_O1) || (en==RMEM_O2) || (en==AMEM_OP) || (en==AMEM_O1) || (en==AMEM_O2) || (en==RMEM) || (en==AMEM)) 
 		// printf("; Memory address: %d", addr);
@@ -310,7 +315,7 @@ void Asserts_CheckOneAssert(int na){
 	int operationCode;
 	int operand1;
 	int operand2;
-	int memCell;
+	MEMORYCELL memCell;
 	int valueInPCB;
 
 	switch (op) {
@@ -498,4 +503,21 @@ void Asserts_TerminateAssertions(){
 	if (numOfElementsInAssertsQueue)
 		// printf("Warning, numOfElementsInAssertsQueue unchecked asserts in Asserts queue !!! );
 		ComputerSystem_DebugMessage(92,ERROR,numOfElementsInAssertsQueue);
-};
\ No newline at end of file
+};
+
+// Returns the time of the next assert to check, 0 if there are asserts
+// for all the instants of time, or -1 if there are no more asserts
+// (always -1 in Simulator-fast, where the asserts are not checked)
+int Asserts_NextAssertTime() {
+	int indexInAsserts;
+
+#ifdef NOASSERTS
+	return -1;
+#endif
+	if (beginOfAllTimeAsserts<MAX_ASSERTS)
+		return 0;
+	indexInAsserts=Heap_getFirst(assertsQueue,numOfElementsInAssertsQueue);
+	if (indexInAsserts < 0)
+		return -1;
+	return asserts[indexInAsserts].time;
+}
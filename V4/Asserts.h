@@ -1,6 +1,8 @@
 #ifndef CHECKASSERTS_H
 #define CHECKASSERTS_H
 
+#include "MainMemory.h"
+
 #define MAXIMUMLENGTH 64
 #define E_SIZE 10 
 
@@ -40,7 +42,7 @@ enum assertList {
 
 typedef struct {
 	int time;
-	int value;
+	MEMORYCELL value; // A whole memory cell for RMEM, AMEM, MBR and MMBR
 	char element[E_SIZE]; 
 	int address;
 } ASSERT_DATA;
@@ -49,6 +51,7 @@ typedef struct {
  int Asserts_LoadAsserts();
  void Asserts_CheckAsserts();
  void Asserts_TerminateAssertions();
+ int Asserts_NextAssertTime();
 
 extern ASSERT_DATA * asserts;
 
@@ -2,6 +2,8 @@
 #include "MMU.h"
 #include "Processor.h"
 #include "MainMemory.h"
+#include "Device.h"
+#include "DMA.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -16,6 +18,9 @@ int Buses_write_AddressBus_From_To(int fromRegister, int toRegister) {
 	case CPU:
 	  data=Processor_GetMAR();
 	  break;
+	case DMA:
+	  data=DMA_GetMAR();
+	  break;
 	default:
 	  return Bus_FAIL;
   }
@@ -48,6 +53,13 @@ int Buses_write_DataBus_From_To(int fromRegister, int toRegister) {
 		case CPU:
 			Processor_GetMBR(data);
 			break;
+		case INPUTDEVICE:
+		case OUTPUTDEVICE:
+			Device_GetMBR(fromRegister, data);
+			break;
+		case DMA:
+			DMA_GetMBR(data);
+			break;
 		default:
 			free(data);
 			return Bus_FAIL;
@@ -69,6 +81,21 @@ int Buses_write_DataBus_From_To(int fromRegister, int toRegister) {
 			}
 			Processor_SetMBR(data);
 			break;;
+		case INPUTDEVICE:
+		case OUTPUTDEVICE:
+			if (fromRegister!=CPU) {
+				free(data);
+				return Bus_FAIL;
+			}
+			Device_SetMBR(toRegister, data);
+			break;
+		case DMA:
+			if (fromRegister!=MAINMEMORY) {
+				free(data);
+				return Bus_FAIL;
+			}
+			DMA_SetMBR(data);
+			break;
 		default:
 			free(data);
 			return Bus_FAIL;
@@ -91,6 +118,13 @@ int Buses_write_ControlBus_From_To(int fromRegister, int toRegister){
 		case MMU:
 			control=MMU_GetCTRL();
 			break;
+		case INPUTDEVICE:
+		case OUTPUTDEVICE:
+			control=Device_GetCTRL(fromRegister);
+			break;
+		case DMA:
+			control=DMA_GetCTRL();
+			break;
 		default:
 			return Bus_FAIL;
 	}
@@ -114,6 +148,19 @@ int Buses_write_ControlBus_From_To(int fromRegister, int toRegister){
 			}
 			MMU_SetCTRL(control);
 			break;
+		case INPUTDEVICE:
+		case OUTPUTDEVICE:
+			if (fromRegister!=CPU) {
+				return Bus_FAIL;
+			}
+			Device_SetCTRL(toRegister, control);
+			break;
+		case DMA:
+			if (fromRegister!=MAINMEMORY) {
+				return Bus_FAIL;
+			}
+			DMA_SetCTRL(control);
+			break;
 		default:
 	 		return Bus_FAIL;
 	}
@@ -1,18 +1,22 @@
 #ifndef BUSES_H
 #define BUSES_H
 
-enum BusConnection { MAINMEMORY, MMU, CPU, INPUTDEVICE, OUTPUTDEVICE };
+#include "MainMemory.h"
+
+enum BusConnection { MAINMEMORY, MMU, CPU, INPUTDEVICE, OUTPUTDEVICE, DMA };
 
 #define Bus_SUCCESS 1
 #define Bus_FAIL -1
 
 #define CTRLREAD 0x1
 #define CTRLWRITE 0x2
+#define CTRLACK 0x4 // Devices: take the oldest served request
+#define CTRLDMA 0x8 // Main memory: operation requested by the DMA controller
 #define CTRL_SUCCESS 0x10
 #define CTRL_FAIL 0x20
 
 typedef struct {
-	int cell;
+	MEMORYCELL cell;
 } BUSDATACELL;
 
 // Functions prototypes
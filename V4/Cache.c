@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "Cache.h"
+#include "Clock.h"
+#include "Processor.h"
+#include "OperatingSystem.h"
+#include "OperatingSystemBase.h"
+#include "ComputerSystem.h"
+
+CACHE caches[NUMBEROFCACHES];
+
+// Tics the processor waits for a line on a miss (--missPenalty option)
+int missPenalty_Cache=CACHEDEFAULTMISSPENALTY;
+
+char *cacheNames[]={"I-cache", "D-cache"};
+char *replacementPolicyNames[]={"lru", "fifo", "random"};
+
+// Functions prototypes
+int Cache_Owner();
+int Cache_SelectVictim(CACHE *, int);
+
+// Look up the line of a physical address in a cache, loading it on a miss
+void Cache_Access(int cache, int physicalAddress) {
+	CACHE *c=&caches[cache];
+	int i, line, tag, first, way, owner;
+
+	if (c->numberOfSets==0)
+		return;
+	line=physicalAddress/c->lineSize;
+	tag=line/c->numberOfSets;
+	first=(line%c->numberOfSets)*c->ways;
+	owner=Cache_Owner();
+	c->time++;
+
+	for (way=first; way<first+c->ways; way++)
+		if (c->lines[way].valid && c->lines[way].tag==tag) {
+			c->hits[owner]++;
+			c->totalHits++;
+			if (c->policy==REPLACEMENT_LRU)
+				c->lines[way].stamp=c->time;
+			return;
+		}
+
+	c->misses[owner]++;
+	c->totalMisses++;
+	way=Cache_SelectVictim(c, first);
+	c->lines[way].valid=1;
+	c->lines[way].tag=tag;
+	c->lines[way].stamp=c->time;
+	for (i=0; i<missPenalty_Cache; i++)
+		Clock_Update();
+}
+
+// Look up every line of a block of cells, once per line
+void Cache_AccessBlock(int cache, int physicalAddress, int length) {
+	int address, lineSize=caches[cache].lineSize;
+
+	if (caches[cache].numberOfSets==0)
+		return;
+	for (address=physicalAddress; address<physicalAddress+length; address=(address/lineSize+1)*lineSize)
+		Cache_Access(cache, address);
+}
+
+// Way of a set (its first line is first) to load a new line in: a free one,
+// or the one the replacement policy selects
+int Cache_SelectVictim(CACHE *c, int first) {
+	int way, victim=first;
+
+	for (way=first; way<first+c->ways; way++) {
+		if (!c->lines[way].valid)
+			return way;
+		if (c->lines[way].stamp<c->lines[victim].stamp)
+			victim=way;
+	}
+	if (c->policy==REPLACEMENT_RANDOM) {
+		c->randomState=c->randomState*1103515245+12345;
+		victim=first+(c->randomState>>16)%c->ways;
+	}
+	return victim;
+}
+
+// Counters charged with an access: the OS ones while its handlers run (with
+// interrupts masked), else the ones of the executing process
+int Cache_Owner() {
+	int PID=OperatingSystem_GetExecutingProcessID();
+
+	if (PID==NOPROCESS || Processor_PSW_BitState(INTERRUPT_MASKED_BIT))
+		return CACHEOSOWNER;
+	return PID;
+}
+
+// Enable a cache with a configuration "sets,ways,lineSize[,lru|fifo|random]"
+// Return 1 if the configuration is valid, 0 else
+int Cache_Configure(int cache, char *configuration) {
+	int sets, ways, lineSize, policy=REPLACEMENT_LRU;
+	char policyName[16];
+	int fields;
+
+	if (configuration==NULL)
+		return 0;
+	fields=sscanf(configuration,"%d,%d,%d,%15s",&sets,&ways,&lineSize,policyName);
+	if (fields<3 || sets<=0 || ways<=0 || lineSize<=0 || sets>CACHEMAXLINES/ways)
+		return 0;
+	if (fields==4) {
+		for (policy=0; policy<NUMBEROFREPLACEMENTPOLICIES; policy++)
+			if (strcasecmp(replacementPolicyNames[policy], policyName)==0)
+				break;
+		if (policy==NUMBEROFREPLACEMENTPOLICIES)
+			return 0;
+	}
+	memset(&caches[cache], 0, sizeof(CACHE));
+	caches[cache].numberOfSets=sets;
+	caches[cache].ways=ways;
+	caches[cache].lineSize=lineSize;
+	caches[cache].policy=policy;
+	caches[cache].randomState=1;
+	return 1;
+}
+
+// Set the tics of a miss. Return 1 if the value is valid, 0 else
+int Cache_SetMissPenalty(char *tics) {
+	int penalty;
+
+	if (tics==NULL || sscanf(tics,"%d",&penalty)!=1 || penalty<0)
+		return 0;
+	missPenalty_Cache=penalty;
+	return 1;
+}
+
+// Returns 1 if any cache is enabled, 0 else
+int Cache_IsEnabled() {
+	return caches[INSTRUCTIONCACHE].numberOfSets>0 || caches[DATACACHE].numberOfSets>0;
+}
+
+// Show the hits and misses of every enabled cache, in total and for the OS
+// and the processes that have not terminated
+void Cache_PrintReport() {
+	int cache, PID;
+	CACHE *c;
+
+	if (!Cache_IsEnabled())
+		return;
+
+	ComputerSystem_DebugMessage(193,SHUTDOWN,missPenalty_Cache);
+	for (cache=0; cache<NUMBEROFCACHES; cache++) {
+		c=&caches[cache];
+		if (c->numberOfSets==0)
+			continue;
+		ComputerSystem_DebugMessage(194,SHUTDOWN,cacheNames[cache],c->numberOfSets,c->ways,c->lineSize,
+			replacementPolicyNames[c->policy],c->totalHits,c->totalMisses);
+	}
+	ComputerSystem_DebugMessage(195,SHUTDOWN,"Operating system",
+		caches[INSTRUCTIONCACHE].hits[CACHEOSOWNER],caches[INSTRUCTIONCACHE].misses[CACHEOSOWNER],
+		caches[DATACACHE].hits[CACHEOSOWNER],caches[DATACACHE].misses[CACHEOSOWNER]);
+
+	for (PID=0; PID<PROCESSTABLEMAXSIZE; PID++)
+		if (processTable[PID].busy && processTable[PID].state!=EXIT)
+			Cache_PrintProcessReport(PID, SHUTDOWN);
+}
+
+// Show the hits and misses of a process, if it has used the caches, and start
+// its counters again for the next process with its PID
+void Cache_PrintProcessReport(int PID, char section) {
+	int cache, accesses=0;
+
+	for (cache=0; cache<NUMBEROFCACHES; cache++)
+		accesses+=caches[cache].hits[PID]+caches[cache].misses[PID];
+	if (accesses>0) {
+		OperatingSystem_ShowTime(section);
+		ComputerSystem_DebugMessage(197,section,PID,programList[processTable[PID].programListIndex]->executableName,
+			caches[INSTRUCTIONCACHE].hits[PID],caches[INSTRUCTIONCACHE].misses[PID],
+			caches[DATACACHE].hits[PID],caches[DATACACHE].misses[PID]);
+	}
+	for (cache=0; cache<NUMBEROFCACHES; cache++) {
+		caches[cache].hits[PID]=0;
+		caches[cache].misses[PID]=0;
+	}
+}
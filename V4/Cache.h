@@ -0,0 +1,54 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "Simulator.h"
+
+// Instruction and data caches between the MMU and main memory. They only keep
+// the tags of the lines they hold: the cells are always read and written in
+// main memory, and a miss costs missPenalty_Cache tics of the clock. A cache
+// with no sets is disabled (the default)
+enum Caches {INSTRUCTIONCACHE, DATACACHE, NUMBEROFCACHES};
+
+enum ReplacementPolicies {REPLACEMENT_LRU, REPLACEMENT_FIFO, REPLACEMENT_RANDOM, NUMBEROFREPLACEMENTPOLICIES};
+
+// Maximum number of lines (sets x ways) of a cache
+#define CACHEMAXLINES 1024
+
+#define CACHEDEFAULTMISSPENALTY 4
+
+// Counters are kept for every process, by PID, and for the OS code (run with
+// interrupts masked). The ones of a process are reported when it terminates
+// and start again from zero for the next process with its PID
+#define CACHEOSOWNER PROCESSTABLEMAXSIZE
+#define CACHEOWNERS (PROCESSTABLEMAXSIZE+1)
+
+typedef struct {
+	int valid;
+	int tag;
+	int stamp; // Time of the last use (LRU) or of the load (FIFO)
+} CACHE_LINE;
+
+typedef struct {
+	int numberOfSets;
+	int ways;
+	int lineSize; // Cells
+	int policy;
+	int time; // Accesses, used to stamp the lines
+	unsigned int randomState; // For the random replacement policy
+	CACHE_LINE lines[CACHEMAXLINES]; // The ways of a set are together
+	int hits[CACHEOWNERS];
+	int misses[CACHEOWNERS];
+	int totalHits; // Of all the processes, also the terminated ones
+	int totalMisses;
+} CACHE;
+
+// Functions prototypes
+void Cache_Access(int, int);
+void Cache_AccessBlock(int, int, int);
+int Cache_Configure(int, char *);
+int Cache_SetMissPenalty(char *);
+int Cache_IsEnabled();
+void Cache_PrintReport();
+void Cache_PrintProcessReport(int, char);
+
+#endif
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Checkpoint.h"
+#include "ComputerSystem.h"
+#include "ComputerSystemBase.h"
+#include "OperatingSystem.h"
+#include "OperatingSystemBase.h"
+#include "MainMemory.h"
+#include "Processor.h"
+#include "Heap.h"
+#include "Device.h"
+#include "DMA.h"
+#include "Cache.h"
+
+// Functions prototypes
+void Checkpoint_Data(FILE *, void *, size_t, int);
+int Checkpoint_Header(FILE *, int);
+void Checkpoint_ProgramList(FILE *, int);
+int Checkpoint_Machine(FILE *, int);
+void Checkpoint_SwappedImages(FILE *, int);
+
+// Hardware state
+extern int registerPC_CPU;
+extern int registerAccumulator_CPU;
+extern BUSDATACELL registerIR_CPU;
+extern unsigned int registerPSW_CPU;
+extern int registerMAR_CPU;
+extern BUSDATACELL registerMBR_CPU;
+extern int registerCTRL_CPU;
+extern int registerA_CPU;
+extern int registerB_CPU;
+extern int registerSP_CPU;
+extern int registerSPLimit_CPU;
+extern int interruptLines_CPU;
+extern int interruptPriority_PIC[];
+extern unsigned int interruptBatch_PIC;
+extern int interruptVectorTable[];
+extern MEMORYCELL mainMemory[];
+extern int registerMAR_MainMemory;
+extern MEMORYCELL registerMBR_MainMemory;
+extern int registerCTRL_MainMemory;
+extern int registerBase_MMU;
+extern int registerLimit_MMU;
+extern int registerMAR_MMU;
+extern int registerCTRL_MMU;
+extern int tics;
+
+// Operating system state
+extern int executingProcessID;
+extern int initialPID;
+extern int numberOfClockInterrupts;
+extern int numberOfNotTerminatedUserProcesses;
+extern heapItem readyToRunQueue[NUMBEROFQUEUES][PROCESSTABLEMAXSIZE];
+extern int numberOfReadyToRunProcesses[];
+extern int counter; // Heap insertionOrder counter
+extern int cfsMinVruntime;
+extern double realTimeUtilization;
+extern int numberOfRealTimeJobs;
+extern int numberOfDeadlineMisses;
+extern long manifestOffset;
+extern int numberOfSwapOuts;
+extern int numberOfSwapIns;
+extern PENDINGADMISSION pendingAdmissionQueue[];
+extern int numberOfPendingAdmissions;
+extern int deviceWaitQueue[NUMBEROFDEVICES][DEVICEQUEUEMAXSIZE];
+extern int numberOfProcessesWaitingDevice[];
+extern int dmaSwapInPID;
+extern int dmaSwapOutPID;
+extern DMA_DESCRIPTOR registerDescriptor_DMA;
+extern int transferredCells_DMA;
+extern int registerMAR_DMA;
+extern MEMORYCELL registerMBR_DMA;
+extern int registerCTRL_DMA;
+extern MEMORYCELL buffer_DMA[];
+extern CACHE caches[];
+extern int manifestBaseIndex;
+extern int lastManifestArrivalTime;
+
+// Configuration options
+extern int mlfqLevels;
+extern int mlfqQuantum[];
+extern int mlfqAgingInterval;
+extern int burst_DMA;
+extern int blockCellsPerTic;
+extern int missPenalty_Cache;
+
+int checkpointTime=-1; // No checkpoint by default
+char *checkpointFile=NULL;
+char *restoreFile=NULL;
+
+// Set to 1 when a read or write operation over the checkpoint file fails
+int checkpointError;
+
+// Save (writing=1) or load (writing=0) a block of the machine state
+void Checkpoint_Data(FILE *file, void *data, size_t size, int writing) {
+	size_t rc;
+	if (checkpointError)
+		return;
+	if (writing)
+		rc=fwrite(data, size, 1, file);
+	else
+		rc=fread(data, size, 1, file);
+	if (rc!=1)
+		checkpointError=1;
+}
+
+// Save or check the file identification and the sizes the machine was compiled with
+int Checkpoint_Header(FILE *file, int writing) {
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	int sizes[6]={CHECKPOINT_VERSION, MAINMEMORYSIZE, sizeof(MEMORYCELL), PROCESSTABLEMAXSIZE, PROGRAMSMAXNUMBER, PARTITIONTABLEMAXSIZE};
+	int savedSizes[6];
+
+	if (writing) {
+		Checkpoint_Data(file, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC), writing);
+		Checkpoint_Data(file, sizes, sizeof(sizes), writing);
+		return checkpointError ? CHECKPOINT_FAIL : CHECKPOINT_SUCCESS;
+	}
+	Checkpoint_Data(file, magic, sizeof(magic), writing);
+	Checkpoint_Data(file, savedSizes, sizeof(savedSizes), writing);
+	if (checkpointError
+		|| memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic))!=0
+		|| memcmp(sizes, savedSizes, sizeof(sizes))!=0)
+		return CHECKPOINT_FAIL;
+	return CHECKPOINT_SUCCESS;
+}
+
+// Save or load the program list (name, arrival time and type of every program)
+void Checkpoint_ProgramList(FILE *file, int writing) {
+	int i, present, length;
+
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		present=(programList[i]!=NULL);
+		Checkpoint_Data(file, &present, sizeof(present), writing);
+		if (!present || checkpointError) {
+			if (!writing)
+				programList[i]=NULL;
+			continue;
+		}
+		if (writing)
+			length=strlen(programList[i]->executableName)+1;
+		else
+			programList[i]=(PROGRAMS_DATA *) malloc(sizeof(PROGRAMS_DATA));
+		Checkpoint_Data(file, &length, sizeof(length), writing);
+		if (!writing) {
+			if (checkpointError || length<=0 || length>MAXLINELENGTH) {
+				checkpointError=1;
+				programList[i]->executableName=NULL;
+				continue;
+			}
+			programList[i]->executableName=(char *) malloc(length*sizeof(char));
+		}
+		Checkpoint_Data(file, programList[i]->executableName, length, writing);
+		Checkpoint_Data(file, &programList[i]->arrivalTime, sizeof(programList[i]->arrivalTime), writing);
+		Checkpoint_Data(file, &programList[i]->type, sizeof(programList[i]->type), writing);
+	}
+}
+
+// Save or load the memory images of the swapped out processes. The swap file
+// goes on changing after the checkpoint is taken, so it can not be trusted to
+// still hold them: they are saved in the checkpoint and written back in the
+// swap file of the restored machine
+void Checkpoint_SwappedImages(FILE *file, int writing) {
+	static MEMORYCELL image[MAINMEMORYSIZE];
+	int PID;
+
+	// The memory of a process being swapped out goes to the swap file at the DMA end
+	if (!writing && dmaSwapOutPID!=NOPROCESS && swapFile==NULL) {
+		ComputerSystem_DebugMessage(196,ERROR);
+		checkpointError=1;
+		return;
+	}
+	for (PID=0; PID<PROCESSTABLEMAXSIZE && !checkpointError; PID++) {
+		if (!processTable[PID].busy || processTable[PID].state!=SWAPPED)
+			continue;
+		if (!writing && swapFile==NULL) {
+			ComputerSystem_DebugMessage(196,ERROR);
+			checkpointError=1;
+			return;
+		}
+		if (writing && OperatingSystem_SwapImage(PID, image, 0)!=SUCCESS)
+			checkpointError=1;
+		Checkpoint_Data(file, image, processTable[PID].processSize*sizeof(MEMORYCELL), writing);
+		if (!writing && !checkpointError && OperatingSystem_SwapImage(PID, image, 1)!=SUCCESS)
+			checkpointError=1;
+	}
+}
+
+// Save or load the complete machine state. The same function is used in both
+// directions so the order of the fields is always the same
+int Checkpoint_Machine(FILE *file, int writing) {
+
+	checkpointError=0;
+	if (Checkpoint_Header(file, writing)==CHECKPOINT_FAIL)
+		return CHECKPOINT_FAIL;
+
+	// Processor
+	Checkpoint_Data(file, &registerPC_CPU, sizeof(registerPC_CPU), writing);
+	Checkpoint_Data(file, &registerAccumulator_CPU, sizeof(registerAccumulator_CPU), writing);
+	Checkpoint_Data(file, &registerIR_CPU, sizeof(registerIR_CPU), writing);
+	Checkpoint_Data(file, &registerPSW_CPU, sizeof(registerPSW_CPU), writing);
+	Checkpoint_Data(file, &registerMAR_CPU, sizeof(registerMAR_CPU), writing);
+	Checkpoint_Data(file, &registerMBR_CPU, sizeof(registerMBR_CPU), writing);
+	Checkpoint_Data(file, &registerCTRL_CPU, sizeof(registerCTRL_CPU), writing);
+	Checkpoint_Data(file, &registerA_CPU, sizeof(registerA_CPU), writing);
+	Checkpoint_Data(file, &registerB_CPU, sizeof(registerB_CPU), writing);
+	Checkpoint_Data(file, &registerSP_CPU, sizeof(registerSP_CPU), writing);
+	Checkpoint_Data(file, &registerSPLimit_CPU, sizeof(registerSPLimit_CPU), writing);
+	Checkpoint_Data(file, &interruptLines_CPU, sizeof(interruptLines_CPU), writing);
+	Checkpoint_Data(file, interruptVectorTable, INTERRUPTTYPES*sizeof(int), writing);
+	Checkpoint_Data(file, interruptPriority_PIC, INTERRUPTTYPES*sizeof(int), writing);
+	Checkpoint_Data(file, &interruptBatch_PIC, sizeof(interruptBatch_PIC), writing);
+	Checkpoint_Data(file, &interruptBatchMode, sizeof(interruptBatchMode), writing);
+	Checkpoint_Data(file, &blockCellsPerTic, sizeof(blockCellsPerTic), writing);
+
+	// Main memory
+	Checkpoint_Data(file, mainMemory, MAINMEMORYSIZE*sizeof(MEMORYCELL), writing);
+	Checkpoint_Data(file, &registerMAR_MainMemory, sizeof(registerMAR_MainMemory), writing);
+	Checkpoint_Data(file, &registerMBR_MainMemory, sizeof(registerMBR_MainMemory), writing);
+	Checkpoint_Data(file, &registerCTRL_MainMemory, sizeof(registerCTRL_MainMemory), writing);
+
+	// MMU
+	Checkpoint_Data(file, &registerBase_MMU, sizeof(registerBase_MMU), writing);
+	Checkpoint_Data(file, &registerLimit_MMU, sizeof(registerLimit_MMU), writing);
+	Checkpoint_Data(file, &registerMAR_MMU, sizeof(registerMAR_MMU), writing);
+	Checkpoint_Data(file, &registerCTRL_MMU, sizeof(registerCTRL_MMU), writing);
+
+	// Clock
+	Checkpoint_Data(file, &tics, sizeof(tics), writing);
+	Checkpoint_Data(file, &intervalBetweenInterrupts, sizeof(intervalBetweenInterrupts), writing);
+
+	// I/O devices
+	Checkpoint_Data(file, devices, NUMBEROFDEVICES*sizeof(DEVICE), writing);
+
+	// DMA controller
+	Checkpoint_Data(file, &registerDescriptor_DMA, sizeof(registerDescriptor_DMA), writing);
+	Checkpoint_Data(file, &transferredCells_DMA, sizeof(transferredCells_DMA), writing);
+	Checkpoint_Data(file, &registerMAR_DMA, sizeof(registerMAR_DMA), writing);
+	Checkpoint_Data(file, &registerMBR_DMA, sizeof(registerMBR_DMA), writing);
+	Checkpoint_Data(file, &registerCTRL_DMA, sizeof(registerCTRL_DMA), writing);
+	Checkpoint_Data(file, buffer_DMA, DMABUFFERSIZE*sizeof(MEMORYCELL), writing);
+	Checkpoint_Data(file, &burst_DMA, sizeof(burst_DMA), writing);
+
+	// Caches: configuration, lines and counters
+	Checkpoint_Data(file, caches, NUMBEROFCACHES*sizeof(CACHE), writing);
+	Checkpoint_Data(file, &missPenalty_Cache, sizeof(missPenalty_Cache), writing);
+
+	// Scheduling and admission policies: the ready queues are ordered by the
+	// key of the policy they were built with
+	Checkpoint_Data(file, &schedulingPolicy, sizeof(schedulingPolicy), writing);
+	Checkpoint_Data(file, &mlfqLevels, sizeof(mlfqLevels), writing);
+	Checkpoint_Data(file, mlfqQuantum, MLFQMAXLEVELS*sizeof(int), writing);
+	Checkpoint_Data(file, &mlfqAgingInterval, sizeof(mlfqAgingInterval), writing);
+	Checkpoint_Data(file, &roundRobinQuantum, sizeof(roundRobinQuantum), writing);
+	Checkpoint_Data(file, &cfsGranularity, sizeof(cfsGranularity), writing);
+	Checkpoint_Data(file, &admissionPolicy, sizeof(admissionPolicy), writing);
+
+	// Operating system
+	Checkpoint_Data(file, processTable, PROCESSTABLEMAXSIZE*sizeof(PCB), writing);
+	Checkpoint_Data(file, partitionsTable, PARTITIONTABLEMAXSIZE*sizeof(PARTITIONDATA), writing);
+	Checkpoint_Data(file, &executingProcessID, sizeof(executingProcessID), writing);
+	Checkpoint_Data(file, &sipID, sizeof(sipID), writing);
+	Checkpoint_Data(file, &initialPID, sizeof(initialPID), writing);
+	Checkpoint_Data(file, &baseDaemonsInProgramList, sizeof(baseDaemonsInProgramList), writing);
+	Checkpoint_Data(file, &numberOfClockInterrupts, sizeof(numberOfClockInterrupts), writing);
+	Checkpoint_Data(file, &numberOfNotTerminatedUserProcesses, sizeof(numberOfNotTerminatedUserProcesses), writing);
+	Checkpoint_Data(file, readyToRunQueue, sizeof(heapItem)*NUMBEROFQUEUES*PROCESSTABLEMAXSIZE, writing);
+	Checkpoint_Data(file, numberOfReadyToRunProcesses, NUMBEROFQUEUES*sizeof(int), writing);
+	Checkpoint_Data(file, sleepingProcessesQueue, PROCESSTABLEMAXSIZE*sizeof(heapItem), writing);
+	Checkpoint_Data(file, &numberOfSleepingProcesses, sizeof(numberOfSleepingProcesses), writing);
+	Checkpoint_Data(file, arrivalTimeQueue, PROGRAMSMAXNUMBER*sizeof(heapItem), writing);
+	Checkpoint_Data(file, &numberOfProgramsInArrivalTimeQueue, sizeof(numberOfProgramsInArrivalTimeQueue), writing);
+	Checkpoint_Data(file, &counter, sizeof(counter), writing);
+	Checkpoint_Data(file, &accountingTotals, sizeof(accountingTotals), writing);
+	Checkpoint_Data(file, &cfsMinVruntime, sizeof(cfsMinVruntime), writing);
+	Checkpoint_Data(file, &realTimeUtilization, sizeof(realTimeUtilization), writing);
+	Checkpoint_Data(file, &numberOfRealTimeJobs, sizeof(numberOfRealTimeJobs), writing);
+	Checkpoint_Data(file, &numberOfDeadlineMisses, sizeof(numberOfDeadlineMisses), writing);
+	Checkpoint_Data(file, &numberOfSwapOuts, sizeof(numberOfSwapOuts), writing);
+	Checkpoint_Data(file, &numberOfSwapIns, sizeof(numberOfSwapIns), writing);
+	Checkpoint_Data(file, pendingAdmissionQueue, PROGRAMSMAXNUMBER*sizeof(PENDINGADMISSION), writing);
+	Checkpoint_Data(file, &numberOfPendingAdmissions, sizeof(numberOfPendingAdmissions), writing);
+	Checkpoint_Data(file, deviceWaitQueue, sizeof(int)*NUMBEROFDEVICES*DEVICEQUEUEMAXSIZE, writing);
+	Checkpoint_Data(file, numberOfProcessesWaitingDevice, NUMBEROFDEVICES*sizeof(int), writing);
+	Checkpoint_Data(file, &dmaSwapInPID, sizeof(dmaSwapInPID), writing);
+	Checkpoint_Data(file, &dmaSwapOutPID, sizeof(dmaSwapOutPID), writing);
+	Checkpoint_SwappedImages(file, writing);
+
+	// Program list and position in the manifest
+	Checkpoint_ProgramList(file, writing);
+	Checkpoint_Data(file, &manifestOffset, sizeof(manifestOffset), writing);
+	Checkpoint_Data(file, &manifestBaseIndex, sizeof(manifestBaseIndex), writing);
+	Checkpoint_Data(file, &lastManifestArrivalTime, sizeof(lastManifestArrivalTime), writing);
+
+	return checkpointError ? CHECKPOINT_FAIL : CHECKPOINT_SUCCESS;
+}
+
+// Save the complete machine state in a checkpoint file
+int Checkpoint_Save(char *fileName) {
+	int rc;
+	FILE *file=fopen(fileName, "wb");
+
+	if (file==NULL)
+		return CHECKPOINT_FAIL;
+	rc=Checkpoint_Machine(file, 1);
+	if (fclose(file)!=0)
+		rc=CHECKPOINT_FAIL;
+	return rc;
+}
+
+// Load the complete machine state from a checkpoint file
+int Checkpoint_Restore(char *fileName) {
+	int rc;
+	FILE *file=fopen(fileName, "rb");
+
+	if (file==NULL)
+		return CHECKPOINT_FAIL;
+	rc=Checkpoint_Machine(file, 0);
+	fclose(file);
+	return rc;
+}
+
+// Parse the value of the --checkpoint option: tick:file
+// Return CHECKPOINT_FAIL if the value is not valid
+int Checkpoint_ParseOption(char *optionValue) {
+	char *time, *file;
+
+	if (optionValue==NULL)
+		return CHECKPOINT_FAIL;
+	time=strtok(optionValue,":");
+	file=strtok(NULL,"");
+	if (time==NULL || file==NULL || sscanf(time,"%d",&checkpointTime)!=1 || checkpointTime<0) {
+		checkpointTime=-1;
+		return CHECKPOINT_FAIL;
+	}
+	checkpointFile=file;
+	return CHECKPOINT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// A checkpoint file stores the complete state of the simulated machine:
+// hardware registers, main memory, MMU, OS tables and queues, clock and program list.
+// It also keeps the configuration options the state depends on (scheduling
+// policy, quanta, admission policy...): a restored machine goes on with the
+// ones it was saved with, whatever the options given to the restoring simulator
+
+#define CHECKPOINT_MAGIC "SSOOCKPT"
+#define CHECKPOINT_VERSION 20
+
+#define CHECKPOINT_SUCCESS 0
+#define CHECKPOINT_FAIL -1
+
+// Functions prototypes
+int Checkpoint_Save(char *);
+int Checkpoint_Restore(char *);
+int Checkpoint_ParseOption(char *);
+
+// Time (tics) at which the checkpoint is taken (-1 if none) and file to save it in
+extern int checkpointTime;
+extern char *checkpointFile;
+
+// File with the checkpoint to restore at power on (NULL if none)
+extern char *restoreFile;
+
+#endif
@@ -1,6 +1,8 @@
 #include "Clock.h"
 #include "Processor.h"
 #include "ComputerSystemBase.h"
+#include "Device.h"
+#include "DMA.h"
 
 int tics=0;
 
@@ -9,6 +11,8 @@ void Clock_Update() {
 
 	tics++;
     // ComputerSystem_DebugMessage(97,CLOCK,tics);
+	Device_Update();
+	DMA_Update();
 	if (tics % intervalBetweenInterrupts == 0) {
 		Processor_RaiseInterrupt(CLOCKINT_BIT);
 	}
@@ -19,3 +23,10 @@ int Clock_GetTime() {
 
 	return tics;
 }
+
+// Advance the clock a number of tics whose clock interrupts have already been
+// accounted for by the caller (used to skip idle time)
+void Clock_FastForward(int skippedTics) {
+
+	tics+=skippedTics;
+}
@@ -4,5 +4,6 @@
 // Functions prototypes
 void Clock_Update();
 int Clock_GetTime();
+void Clock_FastForward(int);
 
 #endif
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ComputerSystem.h"
 #include "OperatingSystem.h"
 #include "ComputerSystemBase.h"
@@ -7,10 +8,14 @@
 #include "Messages.h"
 #include "Asserts.h"
 #include "Clock.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
+#include "Cache.h"
 
 // Functions prototypes
 void ComputerSystem_PrintProgramList();
 void ComputerSystem_ShowTime(char);
+int ComputerSystem_FreeManifestEntry();
 
 // Array that contains basic data about all daemons
 // and all user programs specified in the command line
@@ -20,6 +25,16 @@ PROGRAMS_DATA *programList[PROGRAMSMAXNUMBER];
 heapItem arrivalTimeQueue[PROGRAMSMAXNUMBER];
 int numberOfProgramsInArrivalTimeQueue=0; 
 
+// Programs read from the --manifest file. Only its next program is in the
+// arrival time queue, so the memory used does not depend on its length.
+// The programs use the entries of programList from manifestBaseIndex on,
+// reused once the processes created from them have gone
+char *manifestFile=NULL;
+FILE *manifest=NULL;
+long manifestOffset=-1; // Position of the next line to read (-1 if the manifest has ended)
+int manifestBaseIndex=PROGRAMSMAXNUMBER;
+int lastManifestArrivalTime=0;
+
 // Powers on of the Computer System.
 void ComputerSystem_PowerOn(int argc, char *argv[], int paramIndex) {
 
@@ -35,15 +50,30 @@ void ComputerSystem_PowerOn(int argc, char *argv[], int paramIndex) {
 	}
 	nm=Messages_Load_Messages(nm,STUDENT_MESSAGES_FILE);
 
+#ifndef NOASSERTS
 	// Prepare if necesary the assert system
 	Asserts_LoadAsserts();
+#endif
 
-	// Print program list
-	ComputerSystem_PrintProgramList();
+	if (restoreFile==NULL) {
+		// Print program list
+		ComputerSystem_PrintProgramList();
 
-	// Request the OS to do the initial set of tasks. The last one will be
-	// the processor allocation to the process with the highest priority
-	OperatingSystem_Initialize(daemonsBaseIndex);
+		// Request the OS to do the initial set of tasks. The last one will be
+		// the processor allocation to the process with the highest priority
+		OperatingSystem_Initialize(daemonsBaseIndex);
+	}
+	else {
+		// The machine continues from the state saved in the checkpoint file
+		if (Checkpoint_Restore(restoreFile)==CHECKPOINT_FAIL) {
+			ComputerSystem_DebugMessage(152,ERROR,restoreFile,"restored");
+			exit(2);
+		}
+		ComputerSystem_ShowTime(POWERON);
+		ComputerSystem_DebugMessage(151,POWERON,restoreFile);
+		ComputerSystem_PrintProgramList();
+		ComputerSystem_ReopenManifest();
+	}
 	
 	// Tell the processor to begin its instruction cycle 
 	Processor_InstructionCycleLoop();
@@ -52,10 +82,35 @@ void ComputerSystem_PowerOn(int argc, char *argv[], int paramIndex) {
 
 // Powers off the CS (the C program ends)
 void ComputerSystem_PowerOff() {
+	int exitCode=0;
+
+	if (!Processor_PSW_BitState(POWEROFF_BIT)) {
+		// The processor has been stopped by --endSimulationTime
+		ComputerSystem_ShowTime(SHUTDOWN);
+		ComputerSystem_DebugMessage(155,SHUTDOWN,endSimulationTime);
+		OperatingSystem_PrintFinalState();
+		exitCode=ENDSIMULATIONBYTIME;
+	}
+	OperatingSystem_PrintAccountingReport();
+	OperatingSystem_PrintRealTimeReport();
+	OperatingSystem_PrintSwapReport();
+	OperatingSystem_PrintPendingAdmissions();
+	if (profile) {
+		ComputerSystem_ShowTime(SHUTDOWN);
+		Profiler_PrintReport();
+	}
+	if (Cache_IsEnabled()) {
+		ComputerSystem_ShowTime(SHUTDOWN);
+		Cache_PrintReport();
+	}
+	if (fastForward) {
+		ComputerSystem_ShowTime(SHUTDOWN);
+		ComputerSystem_DebugMessage(154,SHUTDOWN,numberOfSkippedIdleTics);
+	}
 	ComputerSystem_ShowTime(SHUTDOWN);
 	// Show message in red colour: "END of the simulation\n" 
 	ComputerSystem_DebugMessage(99,SHUTDOWN,"END of the simulation\n"); 
-	exit(0);
+	exit(exitCode);
 }
 
 /////////////////////////////////////////////////////////
@@ -70,7 +125,108 @@ void ComputerSystem_PrintProgramList() {
 	}
 }
 
+// Save the machine state in the file given by the --checkpoint option (only once)
+void ComputerSystem_TakeCheckpoint() {
+	checkpointTime=-1;
+	ComputerSystem_ShowTime(POWERON);
+	if (Checkpoint_Save(checkpointFile)==CHECKPOINT_FAIL)
+		ComputerSystem_DebugMessage(152,ERROR,checkpointFile,"saved");
+	else
+		ComputerSystem_DebugMessage(150,POWERON,checkpointFile);
+}
+
 void ComputerSystem_ShowTime(char section) {
 	ComputerSystem_DebugMessage(100,section,"");
 	ComputerSystem_DebugMessage(Processor_PSW_BitState(EXECUTION_MODE_BIT)?95:94,section,Clock_GetTime());
-}
\ No newline at end of file
+}
+// Open the --manifest file and queue its first program. The entries of
+// programList from baseIndex on are used for the programs of the manifest
+void ComputerSystem_OpenManifest(int baseIndex) {
+	if (manifestFile==NULL)
+		return;
+
+	// The entries of the processes of the manifest and the next program
+	if (PROGRAMSMAXNUMBER-baseIndex < PROCESSTABLEMAXSIZE) {
+		ComputerSystem_DebugMessage(179,ERROR,manifestFile,"too many programs in the command line");
+		return;
+	}
+	manifest=fopen(manifestFile, "r");
+	if (manifest==NULL) {
+		ComputerSystem_DebugMessage(179,ERROR,manifestFile,"it does not exist");
+		return;
+	}
+	manifestBaseIndex=baseIndex;
+	manifestOffset=0;
+	ComputerSystem_NextManifestProgram(baseIndex);
+}
+
+// The LTS has taken the program indexInProgramList from the arrival time queue.
+// If it came from the manifest, the next line of the manifest is queued.
+// Every line is: <program> [arrivalTime], in arrival time order
+void ComputerSystem_NextManifestProgram(int indexInProgramList) {
+	char lineRead[MAXLINELENGTH];
+	char *name, *arrival;
+	int entry, arrivalTime;
+
+	if (manifest==NULL || indexInProgramList<manifestBaseIndex)
+		return;
+
+	// Skip comments and empty lines
+	do {
+		if (fgets(lineRead, MAXLINELENGTH, manifest)==NULL) {
+			fclose(manifest);
+			manifest=NULL;
+			manifestOffset=-1;
+			return;
+		}
+		name=strtok(lineRead," \t\n\r");
+	} while (name==NULL || name[0]=='/');
+	manifestOffset=ftell(manifest);
+
+	// A program without arrival time, or out of order, arrives with the previous one
+	arrival=strtok(NULL," \t\n\r");
+	if (arrival==NULL || sscanf(arrival,"%d",&arrivalTime)!=1 || arrivalTime<lastManifestArrivalTime)
+		arrivalTime=lastManifestArrivalTime;
+	lastManifestArrivalTime=arrivalTime;
+
+	entry=ComputerSystem_FreeManifestEntry();
+	if (programList[entry]==NULL)
+		programList[entry]=(PROGRAMS_DATA *) malloc(sizeof(PROGRAMS_DATA));
+	else
+		free(programList[entry]->executableName);
+	programList[entry]->executableName=(char *) malloc((strlen(name)+1)*sizeof(char));
+	strcpy(programList[entry]->executableName, name);
+	programList[entry]->arrivalTime=arrivalTime;
+	programList[entry]->type=USERPROGRAM;
+	Heap_add(entry, arrivalTimeQueue, QUEUE_ARRIVAL, &numberOfProgramsInArrivalTimeQueue, PROGRAMSMAXNUMBER);
+}
+
+// Return an entry of programList for the manifest that no process uses and
+// no program waiting for admission holds. There is always one: at most
+// PROCESSTABLEMAXSIZE-1 processes (all but the SIP) come from the manifest,
+// and the pending admission queue leaves room for them
+int ComputerSystem_FreeManifestEntry() {
+	int i, PID, used;
+
+	for (i=manifestBaseIndex; i<PROGRAMSMAXNUMBER; i++) {
+		for (used=0, PID=0; PID<PROCESSTABLEMAXSIZE && !used; PID++)
+			used=processTable[PID].busy && processTable[PID].programListIndex==i;
+		if (!used && !OperatingSystem_IsPendingAdmission(i))
+			return i;
+	}
+	return manifestBaseIndex;
+}
+
+// After restoring a checkpoint, the manifest goes on from the line it had
+// reached. It must be given again with --manifest
+void ComputerSystem_ReopenManifest() {
+	if (manifestOffset<0)
+		return;
+	if (manifestFile!=NULL)
+		manifest=fopen(manifestFile, "r");
+	if (manifest==NULL || fseek(manifest, manifestOffset, SEEK_SET)!=0) {
+		ComputerSystem_DebugMessage(179,ERROR,manifestFile!=NULL ? manifestFile : "",
+			"it is needed to go on from the checkpoint");
+		manifestOffset=-1;
+	}
+}
@@ -9,6 +9,13 @@
 // Functions prototypes
 void ComputerSystem_PowerOn(int argc, char *argv[], int);
 void ComputerSystem_PowerOff();
+void ComputerSystem_TakeCheckpoint();
+void ComputerSystem_OpenManifest(int);
+void ComputerSystem_NextManifestProgram(int);
+void ComputerSystem_ReopenManifest();
+
+// Exit code of the simulator when it is stopped by --endSimulationTime
+#define ENDSIMULATIONBYTIME 3
 
 // Sections in which we divide our simulator in terms of
 // debugging messages that show its internal working details
@@ -41,5 +48,7 @@ typedef struct ProgramData {
 // This "extern" declarations enables other source code files to gain access
 // to the variables "programList", etc.
 extern PROGRAMS_DATA *programList[PROGRAMSMAXNUMBER];
+extern char *manifestFile;
+extern int manifestBaseIndex;
 
 #endif
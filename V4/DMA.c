@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include "DMA.h"
+#include "Processor.h"
+
+// Transfer in progress and number of cells already copied
+DMA_DESCRIPTOR registerDescriptor_DMA;
+int transferredCells_DMA=0;
+
+// Registers used to reach main memory through the buses
+int registerMAR_DMA;
+MEMORYCELL registerMBR_DMA;
+int registerCTRL_DMA;
+
+// Cells copied every tic (--dmaBurst option)
+int burst_DMA=DMADEFAULTBURST;
+
+MEMORYCELL buffer_DMA[DMABUFFERSIZE];
+
+// Functions prototypes
+MEMORYCELL DMA_ReadCell(int);
+void DMA_WriteCell(int, MEMORYCELL);
+
+// A tic of the clock: the next burst of the transfer in progress is copied
+void DMA_Update() {
+	int i;
+
+	if (!DMA_IsBusy())
+		return;
+	for (i=0; i<burst_DMA && transferredCells_DMA<registerDescriptor_DMA.length; i++, transferredCells_DMA++)
+		DMA_WriteCell(registerDescriptor_DMA.destination+transferredCells_DMA,
+			DMA_ReadCell(registerDescriptor_DMA.source+transferredCells_DMA));
+	if (transferredCells_DMA==registerDescriptor_DMA.length)
+		Processor_RaiseInterrupt(DMAEND_BIT);
+}
+
+// Returns 1 while a transfer is in progress, 0 else
+int DMA_IsBusy() {
+	return transferredCells_DMA<registerDescriptor_DMA.length;
+}
+
+// Start the transfer of a descriptor. Returns Bus_SUCCESS, or Bus_FAIL if the
+// controller is busy or the descriptor goes out of main memory or the buffer
+int DMA_Start(DMA_DESCRIPTOR *descriptor) {
+	if (DMA_IsBusy() || descriptor->length<=0 || descriptor->source<0 || descriptor->destination<0
+		|| descriptor->source+descriptor->length>DMABUFFERBASE+DMABUFFERSIZE
+		|| descriptor->destination+descriptor->length>DMABUFFERBASE+DMABUFFERSIZE)
+		return Bus_FAIL;
+	registerDescriptor_DMA=*descriptor;
+	transferredCells_DMA=0;
+	return Bus_SUCCESS;
+}
+
+// Set the cells copied every tic. Returns 1 if the burst is valid, 0 else
+int DMA_SetBurst(char *burst) {
+	int cells;
+
+	if (burst==NULL || sscanf(burst,"%d",&cells)!=1 || cells<=0)
+		return 0;
+	burst_DMA=cells;
+	return 1;
+}
+
+// Block device side of the buffer
+MEMORYCELL DMA_ReadBuffer(int index) {
+	return buffer_DMA[index];
+}
+
+void DMA_WriteBuffer(int index, MEMORYCELL cell) {
+	buffer_DMA[index]=cell;
+}
+
+// Read a cell of main memory, through the buses, or of the buffer
+MEMORYCELL DMA_ReadCell(int address) {
+	if (address>=DMABUFFERBASE)
+		return buffer_DMA[address-DMABUFFERBASE];
+	registerMAR_DMA=address;
+	Buses_write_AddressBus_From_To(DMA, MAINMEMORY);
+	registerCTRL_DMA=CTRLREAD | CTRLDMA;
+	Buses_write_ControlBus_From_To(DMA, MAINMEMORY);
+	return registerMBR_DMA;
+}
+
+// Write a cell of main memory, through the buses, or of the buffer
+void DMA_WriteCell(int address, MEMORYCELL cell) {
+	if (address>=DMABUFFERBASE) {
+		buffer_DMA[address-DMABUFFERBASE]=cell;
+		return;
+	}
+	registerMAR_DMA=address;
+	Buses_write_AddressBus_From_To(DMA, MAINMEMORY);
+	registerMBR_DMA=cell;
+	Buses_write_DataBus_From_To(DMA, MAINMEMORY);
+	registerCTRL_DMA=CTRLWRITE | CTRLDMA;
+	Buses_write_ControlBus_From_To(DMA, MAINMEMORY);
+}
+
+int DMA_GetMAR() {
+	return registerMAR_DMA;
+}
+
+int DMA_GetCTRL() {
+	return registerCTRL_DMA;
+}
+
+void DMA_SetCTRL(int ctrl) {
+	registerCTRL_DMA=ctrl;
+}
+
+void DMA_GetMBR(BUSDATACELL *data) {
+	data->cell=registerMBR_DMA;
+}
+
+void DMA_SetMBR(BUSDATACELL *data) {
+	registerMBR_DMA=data->cell;
+}
@@ -0,0 +1,35 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include "Buses.h"
+#include "MainMemory.h"
+
+// DMA controller: copies a block of cells without the processor, a burst of
+// them every tic, and raises the DMAEND interrupt line when the copy ends.
+// Descriptor addresses below DMABUFFERBASE are physical main memory addresses;
+// from DMABUFFERBASE on, cells of its buffer, which the OS fills and empties
+// as the controller of a block device
+#define DMABUFFERBASE MAINMEMORYSIZE
+#define DMABUFFERSIZE MAINMEMORYSIZE
+#define DMADEFAULTBURST 4
+
+typedef struct {
+	int source;
+	int destination;
+	int length;
+} DMA_DESCRIPTOR;
+
+// Functions prototypes
+void DMA_Update();
+int DMA_IsBusy();
+int DMA_Start(DMA_DESCRIPTOR *);
+int DMA_SetBurst(char *);
+MEMORYCELL DMA_ReadBuffer(int);
+void DMA_WriteBuffer(int, MEMORYCELL);
+int DMA_GetMAR();
+int DMA_GetCTRL();
+void DMA_SetCTRL(int);
+void DMA_GetMBR(BUSDATACELL *);
+void DMA_SetMBR(BUSDATACELL *);
+
+#endif
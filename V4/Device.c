@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include "Device.h"
+#include "Processor.h"
+
+// The devices, indexed by DEVICEINDEX
+DEVICE devices[NUMBEROFDEVICES]={
+	{DEVICEDEFAULTLATENCY, {0}, 0, 0, 0, 0, 1, 0, 0},
+	{DEVICEDEFAULTLATENCY, {0}, 0, 0, 0, 0, 1, 0, 0}
+};
+
+char *deviceNames[NUMBEROFDEVICES]={"INPUT","OUTPUT"};
+
+// A tic of the clock: every device advances its first request not served yet
+void Device_Update() {
+	int i, request;
+	DEVICE *device;
+
+	for (i=0; i<NUMBEROFDEVICES; i++) {
+		device=&devices[i];
+		if (device->numberOfServedRequests==device->numberOfRequests || --device->remainingTics>0)
+			continue;
+		request=(device->first+device->numberOfServedRequests)%DEVICEQUEUEMAXSIZE;
+		// The input device reads the values 1, 2, 3...; the output device shows them
+		if (i==DEVICEINDEX(INPUTDEVICE))
+			device->requests[request]=device->nextInput++;
+		device->numberOfServedRequests++;
+		device->remainingTics=device->latency;
+		Processor_RaiseInterrupt(IOEND_BIT);
+	}
+}
+
+// Returns 1 if a device has requests not served yet, 0 else
+int Device_IsBusy() {
+	int i;
+
+	for (i=0; i<NUMBEROFDEVICES; i++)
+		if (devices[i].numberOfServedRequests<devices[i].numberOfRequests)
+			return 1;
+	return 0;
+}
+
+// Set the latency of the devices from "tics" (both) or "inputTics,outputTics"
+// Returns 1 if the latencies are valid, 0 else
+int Device_SetLatency(char *latencies) {
+	int input, output;
+
+	if (latencies==NULL)
+		return 0;
+	switch (sscanf(latencies,"%d,%d",&input,&output)) {
+		case 1:
+			output=input;
+			break;
+		case 2:
+			break;
+		default:
+			return 0;
+	}
+	if (input<=0 || output<=0)
+		return 0;
+	devices[DEVICEINDEX(INPUTDEVICE)].latency=input;
+	devices[DEVICEINDEX(OUTPUTDEVICE)].latency=output;
+	return 1;
+}
+
+// CTRLREAD (input device) and CTRLWRITE (output device, with the value in the
+// MBR) queue a request; CTRLACK takes the oldest served one, leaving its
+// value in the MBR. The result is CTRL_SUCCESS or CTRL_FAIL
+void Device_SetCTRL(int busConnection, int ctrl) {
+	DEVICE *device=&devices[DEVICEINDEX(busConnection)];
+	int request;
+
+	device->registerCTRL_Device=ctrl&0x7;
+	switch (device->registerCTRL_Device) {
+		case CTRLREAD:
+		case CTRLWRITE:
+			if (device->numberOfRequests==DEVICEQUEUEMAXSIZE
+				|| device->registerCTRL_Device!=(busConnection==INPUTDEVICE ? CTRLREAD : CTRLWRITE)) {
+				device->registerCTRL_Device |= CTRL_FAIL;
+				break;
+			}
+			request=(device->first+device->numberOfRequests)%DEVICEQUEUEMAXSIZE;
+			device->requests[request]=device->registerMBR_Device;
+			// An idle device starts serving the request now
+			if (device->numberOfServedRequests==device->numberOfRequests)
+				device->remainingTics=device->latency;
+			device->numberOfRequests++;
+			device->registerCTRL_Device |= CTRL_SUCCESS;
+			break;
+		case CTRLACK:
+			if (device->numberOfServedRequests==0) {
+				device->registerCTRL_Device |= CTRL_FAIL;
+				break;
+			}
+			device->registerMBR_Device=device->requests[device->first];
+			device->first=(device->first+1)%DEVICEQUEUEMAXSIZE;
+			device->numberOfRequests--;
+			device->numberOfServedRequests--;
+			device->registerCTRL_Device |= CTRL_SUCCESS;
+			break;
+		default:
+			device->registerCTRL_Device |= CTRL_FAIL;
+			break;
+	}
+}
+
+int Device_GetCTRL(int busConnection) {
+	return devices[DEVICEINDEX(busConnection)].registerCTRL_Device;
+}
+
+void Device_SetMBR(int busConnection, BUSDATACELL *data) {
+	devices[DEVICEINDEX(busConnection)].registerMBR_Device=data->cell;
+}
+
+void Device_GetMBR(int busConnection, BUSDATACELL *data) {
+	data->cell=devices[DEVICEINDEX(busConnection)].registerMBR_Device;
+}
@@ -0,0 +1,44 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include "Buses.h"
+#include "Simulator.h"
+
+// Input and output devices, connected to the buses as INPUTDEVICE and
+// OUTPUTDEVICE. A device serves its requests one by one, in arrival order,
+// spending its latency (tics) on each of them, and raises the IOEND interrupt
+// line every time one ends
+#define NUMBEROFDEVICES 2
+#define DEVICEDEFAULTLATENCY 10
+
+// Position in the devices array of the device at a bus connection
+#define DEVICEINDEX(busConnection) ((busConnection)-INPUTDEVICE)
+
+// A process has at most one request in a device
+#define DEVICEQUEUEMAXSIZE PROCESSTABLEMAXSIZE
+
+typedef struct {
+	int latency; // Tics needed to serve a request
+	int requests[DEVICEQUEUEMAXSIZE]; // Circular queue: value written, or value read once served
+	int first;
+	int numberOfRequests;
+	int numberOfServedRequests; // The first ones of the queue, waiting to be acknowledged
+	int remainingTics; // Of the first request not served yet
+	int nextInput; // Value the input device reads next
+	int registerMBR_Device;
+	int registerCTRL_Device;
+} DEVICE;
+
+// Functions prototypes
+void Device_Update();
+int Device_IsBusy();
+int Device_SetLatency(char *);
+void Device_SetCTRL(int, int);
+int Device_GetCTRL(int);
+void Device_SetMBR(int, BUSDATACELL *);
+void Device_GetMBR(int, BUSDATACELL *);
+
+extern DEVICE devices[NUMBEROFDEVICES];
+extern char *deviceNames[NUMBEROFDEVICES];
+
+#endif
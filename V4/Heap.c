@@ -97,7 +97,7 @@ void Heap_swap_Down(int p, heapItem heap[], int queueType, int numElem) {
 
 // Auxiliary for priority comparations
 int Heap_compare_priority(int value1, int value2) {
-  return processTable[value2].priority-processTable[value1].priority;
+  return OperatingSystem_SchedulingKey(value2)-OperatingSystem_SchedulingKey(value1);
 }
 
 // Auxiliary for  WakeUp-time comparations
@@ -0,0 +1,29 @@
+#ifndef HOOKS_H
+#define HOOKS_H
+
+#include "Clock.h"
+#include "Asserts.h"
+#include "OperatingSystemBase.h"
+
+// Actions added to the processor and the OS at fixed points of their code:
+//		- The clock advances before every instruction fetch and before the
+//		  OS handles an interrupt
+//		- The asserts are checked after every executed instruction and
+//		  terminated when the processor stops
+//		- The teacher's daemons are prepared after the OS daemons
+// When NOASSERTS is defined (Simulator-fast target) the assert hooks are
+// empty, so no call is left in the instruction cycle
+
+#define HOOK_BEFORE_FETCHINSTRUCTION() Clock_Update()
+#define HOOK_BEFORE_INTERRUPTLOGIC() Clock_Update()
+#define HOOK_AFTER_PREPAREDAEMONS() OperatingSystem_PrepareTeachersDaemons()
+
+#ifdef NOASSERTS
+#define HOOK_AFTER_DECODEANDEXECUTEINSTRUCTION() ((void) 0)
+#define HOOK_AFTER_INSTRUCTIONCYCLELOOP() ((void) 0)
+#else
+#define HOOK_AFTER_DECODEANDEXECUTEINSTRUCTION() Asserts_CheckAsserts()
+#define HOOK_AFTER_INSTRUCTIONCYCLELOOP() Asserts_TerminateAssertions()
+#endif
+
+#endif
@@ -94,6 +94,21 @@ void MMU_SetCTRL (int ctrl) {
   	Buses_write_ControlBus_From_To(MMU,CPU);
 }
 
+// Translate a block of cells from its first logical address, checking the
+// whole range at once against the limit register (or main memory size in
+// protected mode). Return the first physical address, or -1 if any cell of
+// the block is out of range (the INVALIDADDRESS exception is raised)
+int MMU_TranslateBlock(int logicalAddress, int length) {
+	if (Processor_PSW_BitState(EXECUTION_MODE_BIT)) { // Protected mode
+		if (logicalAddress >= 0 && length >= 0 && logicalAddress <= MAINMEMORYSIZE-length)
+			return logicalAddress;
+	}
+	else if (logicalAddress >= 0 && length >= 0 && logicalAddress <= registerLimit_MMU-length)
+		return logicalAddress+registerBase_MMU;
+	Processor_RaiseException(INVALIDADDRESS);
+	return -1;
+}
+
 // Getter for registerCTRL_MMU
 int MMU_GetCTRL () {
   return registerCTRL_MMU;
@@ -8,6 +8,7 @@ int MMU_GetMAR();
 void MMU_SetMAR(int);
 void MMU_SetBase(int);
 void MMU_SetLimit(int);
+int MMU_TranslateBlock(int, int);
 
 // Used for Asserts
 int MMU_GetBase();
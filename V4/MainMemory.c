@@ -42,6 +42,9 @@ int MainMemory_GetCTRL() {
 
 // Setter for registerCTRL_MainMemory
 void MainMemory_SetCTRL(int ctrl) {
+	// The result goes back to the DMA controller or to the processor, the one that asked
+	int requester=(ctrl & CTRLDMA) ? DMA : CPU;
+
 	registerCTRL_MainMemory=ctrl&0x3;
 	switch (registerCTRL_MainMemory) {
       // To read the contents of a memory cell, the MAR register must point (index) it
@@ -49,7 +52,7 @@ void MainMemory_SetCTRL(int ctrl) {
       // data bus
   		case CTRLREAD:
   	 		memcpy((void *) (&registerMBR_MainMemory), (void *) (&mainMemory[registerMAR_MainMemory]), sizeof(MEMORYCELL));
-  			Buses_write_DataBus_From_To(MAINMEMORY, CPU);
+  			Buses_write_DataBus_From_To(MAINMEMORY, requester);
   			break;
       // To write in a memory cell, the MAR and MBR registers are used, set by the processor,
       // as described previously 
@@ -58,11 +61,66 @@ void MainMemory_SetCTRL(int ctrl) {
     		break;
   		default:
   			registerCTRL_MainMemory |= CTRL_FAIL;
-  			Buses_write_ControlBus_From_To(MAINMEMORY,CPU);
+  			Buses_write_ControlBus_From_To(MAINMEMORY,requester);
   			return;
   			break;
   	}
   	registerCTRL_MainMemory |= CTRL_SUCCESS;
-  	Buses_write_ControlBus_From_To(MAINMEMORY,CPU);
+  	Buses_write_ControlBus_From_To(MAINMEMORY,requester);
+}
+
+// Block operations for the block instructions, on physical addresses already
+// checked by the MMU: copy length cells from source to destination (the ranges
+// may overlap) and fill length cells with a value
+void MainMemory_Copy(int destination, int source, int length) {
+	memmove((void *) (&mainMemory[destination]), (void *) (&mainMemory[source]), length*sizeof(MEMORYCELL));
+}
+
+void MainMemory_Fill(int destination, MEMORYCELL value, int length) {
+	int i;
+	for (i=0; i<length; i++)
+		mainMemory[destination+i]=value;
+}
+
+// Block transfers between main memory and a device with its own buffer (the
+// register file of the processor): read length cells from address into cells
+// and write length cells from cells at address
+void MainMemory_ReadBlock(int address, MEMORYCELL *cells, int length) {
+	memcpy((void *) cells, (void *) (&mainMemory[address]), length*sizeof(MEMORYCELL));
 }
 
+void MainMemory_WriteBlock(int address, MEMORYCELL *cells, int length) {
+	memcpy((void *) (&mainMemory[address]), (void *) cells, length*sizeof(MEMORYCELL));
+}
+
+// Vector operations for the vector instructions, on physical addresses already
+// checked by the MMU. The loops have no branches so that the compiler can use
+// the SIMD instructions of the host. Cells hold int data, as the accumulator,
+// and a result overflows, as in Processor_CheckOverflow, when it does not fit
+// in an int, also with 64-bit cells. The sums of ints never overflow a long long
+
+// Add length cells from source to the ones from destination
+// Return 1 if any of the sums overflows, 0 else
+int MainMemory_VectorAdd(int destination, int source, int length) {
+	int i, overflow=0;
+	long long sum;
+
+	for (i=0; i<length; i++) {
+		sum=(long long) (int) mainMemory[destination+i]+(int) mainMemory[source+i];
+		mainMemory[destination+i]=(int) sum;
+		overflow|=(sum!=(int) sum);
+	}
+	return overflow;
+}
+
+// Add up length cells from source, leaving the result in *sum
+// Return 1 if the total overflows, 0 else
+int MainMemory_VectorSum(int source, int length, int *sum) {
+	int i;
+	long long total=0;
+
+	for (i=0; i<length; i++)
+		total+=(int) mainMemory[source+i];
+	*sum=(int) total;
+	return total!=(int) total;
+}
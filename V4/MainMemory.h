@@ -5,8 +5,16 @@
 // included in Simulator.h
 #include "Simulator.h"
 
-// A memory cell is capable of storing a MEMORYCELL TYPE
+// A memory cell is capable of storing a MEMORYCELL TYPE. Compiled with
+// -DWIDECELLS, cells have 64 bits and instructions have wider operands.
+// MEMORYCELLFORMAT reads and prints a whole cell
+#ifdef WIDECELLS
+typedef long long MEMORYCELL;
+#define MEMORYCELLFORMAT "%lld"
+#else
 typedef int MEMORYCELL;
+#define MEMORYCELLFORMAT "%d"
+#endif
 
 // Function prototypes
 
@@ -16,5 +24,11 @@ void MainMemory_GetMBR(MEMORYCELL *);
 void MainMemory_SetMBR(MEMORYCELL *);
 int MainMemory_GetCTRL();
 void MainMemory_SetCTRL(int);
+void MainMemory_Copy(int, int, int);
+void MainMemory_Fill(int, MEMORYCELL, int);
+void MainMemory_ReadBlock(int, MEMORYCELL *, int);
+void MainMemory_WriteBlock(int, MEMORYCELL *, int);
+int MainMemory_VectorAdd(int, int, int);
+int MainMemory_VectorSum(int, int, int *);
 
 #endif
\ No newline at end of file
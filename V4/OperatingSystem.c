@@ -4,6 +4,14 @@
 #include "Processor.h"
 #include "Buses.h"
 #include "Heap.h"
+#include "Clock.h"
+#include "Device.h"
+#include "DMA.h"
+#include "Asserts.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
+#include "Cache.h"
+#include "Hooks.h"
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -32,6 +40,48 @@ int OperatingSystem_ExtractFromBlocked();
 void OperatingSystem_CheckIfIsNecessaryToChangeProcess();
 void OperatingSystem_ReleaseMainMemory();
 void OperatingSystem_ChangeProcess(int);
+int OperatingSystem_IsInterestingClockInterrupt(int, int);
+int OperatingSystem_SIPIsIdle();
+BUSDATACELL OperatingSystem_ReadPhysicalMemory(int);
+void OperatingSystem_AccountStateTime(int);
+void OperatingSystem_AccountProcess(int);
+void OperatingSystem_RotateExecutingProcess();
+void OperatingSystem_PrepareWokenProcess(int);
+int OperatingSystem_HeapEnqueue(int);
+int OperatingSystem_HeapDequeue(int);
+int OperatingSystem_HeapPeek(int);
+int OperatingSystem_PriorityTick(int);
+int OperatingSystem_PriorityYield(int);
+void OperatingSystem_PriorityWake(int);
+int OperatingSystem_PriorityKey(int);
+int OperatingSystem_MLFQTick(int);
+void OperatingSystem_MLFQWake(int);
+int OperatingSystem_MLFQKey(int);
+void OperatingSystem_MLFQAging();
+int OperatingSystem_CFSTick(int);
+int OperatingSystem_CFSYield(int);
+void OperatingSystem_CFSWake(int);
+int OperatingSystem_CFSKey(int);
+void OperatingSystem_CFSUpdateMinVruntime();
+int OperatingSystem_ObtainRealTimeParameters(FILE *, int, int *, int *, int *);
+void OperatingSystem_ReleaseJob(int, int);
+int OperatingSystem_CompleteJob(int);
+void OperatingSystem_CheckDeadline(int);
+FILE *OperatingSystem_SwapFile();
+int OperatingSystem_SwapOutSleeper(int);
+int OperatingSystem_SwapOut(int);
+void OperatingSystem_EndSwapOut(int);
+int OperatingSystem_SwapIn(int);
+int OperatingSystem_AdmitProgram(int);
+int OperatingSystem_DeferAdmission(int);
+void OperatingSystem_RetryAdmissions();
+int OperatingSystem_SelectPendingAdmission();
+int OperatingSystem_FreePartitionWaste(int);
+int OperatingSystem_StartIO(int, int);
+int OperatingSystem_AcknowledgeIO(int, int *);
+void OperatingSystem_MoveToTheDeviceQueue(int, int);
+void OperatingSystem_HandleIOEndInterrupt();
+void OperatingSystem_HandleDMAEndInterrupt();
 
 // The process table
 PCB processTable[PROCESSTABLEMAXSIZE];
@@ -54,11 +104,80 @@ int baseDaemonsInProgramList;
 // Number of clock interrupts occurred
 int numberOfClockInterrupts = 0;
 
+// Process whose PCB copy of the registers is the context held by the processor
+// (system stack and general purpose registers) during the current OS entry
+int processorContextPID=NOPROCESS;
+
+// Preempted process whose context is still in the processor and has not been
+// saved in its PCB yet: it is only saved if another process is dispatched
+int unsavedContextPID=NOPROCESS;
+
+// Short-term scheduling policies of the user processes, indexed by
+// SchedulingPolicies, and the selected one
+SCHEDULING_POLICY schedulers[NUMBEROFSCHEDULERS]={
+	{"priority", OperatingSystem_HeapEnqueue, OperatingSystem_HeapDequeue, OperatingSystem_HeapPeek,
+		OperatingSystem_PriorityTick, OperatingSystem_PriorityYield, OperatingSystem_PriorityWake, OperatingSystem_PriorityKey},
+	{"mlfq", OperatingSystem_HeapEnqueue, OperatingSystem_HeapDequeue, OperatingSystem_HeapPeek,
+		OperatingSystem_MLFQTick, OperatingSystem_PriorityYield, OperatingSystem_MLFQWake, OperatingSystem_MLFQKey},
+	{"cfs", OperatingSystem_HeapEnqueue, OperatingSystem_HeapDequeue, OperatingSystem_HeapPeek,
+		OperatingSystem_CFSTick, OperatingSystem_CFSYield, OperatingSystem_CFSWake, OperatingSystem_CFSKey}
+};
+int schedulingPolicy=SCHEDULER_PRIORITY;
+
+// Multi-level feedback queue: number of levels, quantum of each level and
+// clock interrupts between two agings (0 if there is no aging)
+int mlfqLevels;
+int mlfqQuantum[MLFQMAXLEVELS];
+int mlfqAgingInterval;
+
+// Round-robin among processes of equal priority: clock interrupts of the
+// time quantum (0 if the processes are not time sliced)
+int roundRobinQuantum=0;
+
+// Completely-fair scheduler: clock interrupts a process keeps the processor
+// before it can be preempted by one with less virtual runtime, and minimum
+// virtual runtime of the user processes (it never decreases)
+int cfsGranularity=CFSDEFAULTGRANULARITY;
+int cfsMinVruntime=0;
+
+// Earliest-deadline-first real-time class: processor utilization of the admitted
+// real-time processes, jobs released and deadlines missed
+double realTimeUtilization=0;
+int numberOfRealTimeJobs=0;
+int numberOfDeadlineMisses=0;
+
+// Medium-term scheduler: swap file (NULL if there is no swapping), its stream
+// and processes swapped out and in
+char *swapFile=NULL;
+FILE *swapStream=NULL;
+int numberOfSwapOuts=0;
+int numberOfSwapIns=0;
+
+// Process whose memory the DMA controller is bringing back from the swap file,
+// and process whose memory it is copying to be written in the swap file
+int dmaSwapInPID=NOPROCESS;
+int dmaSwapOutPID=NOPROCESS;
+
+// Pending admission queue: programs that found no free partition, in arrival
+// order, waiting for one to be released (--admission option)
+int admissionPolicy=ADMISSION_DROP;
+char *admissionPolicyNames[NUMBEROFADMISSIONPOLICIES]={"drop","fifo","smallest","bestfit"};
+PENDINGADMISSION pendingAdmissionQueue[PROGRAMSMAXNUMBER];
+int numberOfPendingAdmissions=0;
+
+// Device wait queues: processes blocked until a device serves their request,
+// in the order of the requests (the order in which the device serves them)
+int deviceWaitQueue[NUMBEROFDEVICES][DEVICEQUEUEMAXSIZE];
+int numberOfProcessesWaitingDevice[NUMBEROFDEVICES]={0,0};
+
 // Array that contains the identifiers of the READY processes
 heapItem readyToRunQueue [NUMBEROFQUEUES][PROCESSTABLEMAXSIZE];
 int numberOfReadyToRunProcesses[NUMBEROFQUEUES]={0,0};
 
-char * queueNames [NUMBEROFQUEUES]={"USER","DAEMONS"}; 
+char * queueNames [NUMBEROFQUEUES]={"USER","DAEMONS","REALTIME"}; 
+
+// Order in which the short-term scheduler looks at the ready-to-run queues
+int schedulingOrder[NUMBEROFQUEUES]={REALTIMEQUEUE, USERPROCESSQUEUE, DAEMONSQUEUE};
 
 // Heap with blocked processes sort by when to wakeup
 heapItem sleepingProcessesQueue[PROCESSTABLEMAXSIZE];
@@ -67,20 +186,32 @@ int numberOfSleepingProcesses=0;
 // Variable containing the number of not terminated user processes
 int numberOfNotTerminatedUserProcesses=0;
 
+// Fast-forward of the idle time of the System Idle Process (--fastForward option)
+int fastForward=0;
+int numberOfSkippedIdleTics=0;
+
+// Scheduling metrics: CSV file with a line per accounted process (--accounting option)
+char *accountingFile=NULL;
+FILE *accountingCSV=NULL;
+ACCOUNTING_DATA accountingTotals;
+
 // Names of the process states
-char * statesNames [5]={"NEW","READY","EXECUTING","BLOCKED","EXIT"};
+char * statesNames [6]={"NEW","READY","EXECUTING","BLOCKED","EXIT","SWAPPED"};
 
 // Initial set of tasks of the OS
 void OperatingSystem_Initialize(int daemonsIndex) {
 	
 	int i, selectedProcess, partitions;
 	FILE *programFile; // For load Operating System Code
+	long programOffset;
 
 	// Obtain the memory requirements of the program
 	int processSize=OperatingSystem_ObtainProgramSize(&programFile, "OperatingSystemCode");
 
 	// Load Operating System Code
+	programOffset=ftell(programFile);
 	OperatingSystem_LoadProgram(programFile, OS_address_base, processSize);
+	Profiler_ProgramLoaded("OperatingSystemCode", programOffset, OS_address_base);
 	
 	// Process table initialization (all entries are free)
 	for (i=0; i<PROCESSTABLEMAXSIZE;i++){
@@ -94,6 +225,8 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 	
 	// Insert programs of program list in arrivalTimeQueue
 	ComputerSystem_FillInArrivalTimeQueue();
+	// The first program of the manifest, if any, after the daemons
+	ComputerSystem_OpenManifest(baseDaemonsInProgramList);
 	OperatingSystem_PrintStatus();
 
 	// Initialize partition table
@@ -144,6 +277,7 @@ void OperatingSystem_PrepareDaemons(int programListDaemonsBase) {
 	// index for aditionals daemons program in programList
 	baseDaemonsInProgramList=programListDaemonsBase;
 
+	HOOK_AFTER_PREPAREDAEMONS();
 }
 
 
@@ -152,47 +286,15 @@ void OperatingSystem_PrepareDaemons(int programListDaemonsBase) {
 // 			command lineand daemons programs
 int OperatingSystem_LongTermScheduler() {
   
-	int PID, i,
-		numberOfSuccessfullyCreatedProcesses=0;
+	int i, numberOfSuccessfullyCreatedProcesses=0;
 	
 	while(OperatingSystem_IsThereANewProgram() == YES) {
 		i = Heap_poll(arrivalTimeQueue, QUEUE_ARRIVAL, &numberOfProgramsInArrivalTimeQueue);
 
-		if (programList[i]->type == DAEMONPROGRAM)
-			PID=OperatingSystem_CreateProcess(i, DAEMONSQUEUE);
-		else
-			PID=OperatingSystem_CreateProcess(i, USERPROCESSQUEUE);
+		numberOfSuccessfullyCreatedProcesses+=OperatingSystem_AdmitProgram(i);
 
-		switch (PID)
-		{
-		case NOFREEENTRY:
-			OperatingSystem_ShowTime(ERROR);
-			ComputerSystem_DebugMessage(103, ERROR, programList[i] -> executableName);
-			break;
-		case PROGRAMDOESNOTEXIST:
-			OperatingSystem_ShowTime(ERROR);
-			ComputerSystem_DebugMessage(104, ERROR, programList[i] -> executableName, "it does not exist");
-			break;
-		case PROGRAMNOTVALID:
-			OperatingSystem_ShowTime(ERROR);
-			ComputerSystem_DebugMessage(104, ERROR, programList[i] -> executableName, "invalid priority or size");
-			break;
-		case TOOBIGPROCESS:
-			OperatingSystem_ShowTime(ERROR);
-			ComputerSystem_DebugMessage(105, ERROR, programList[i] -> executableName);
-			break;
-		case MEMORYFULL:
-			OperatingSystem_ShowTime(ERROR);
-			ComputerSystem_DebugMessage(144, ERROR, programList[i] -> executableName);
-			break;
-		default:
-			numberOfSuccessfullyCreatedProcesses++;
-			if (programList[i]->type==USERPROGRAM) 
-				numberOfNotTerminatedUserProcesses++;
-			// Move process to the ready state
-			OperatingSystem_MoveToTheREADYState(PID);
-			break;
-		}
+		// A program of the manifest leaves room for the next one
+		ComputerSystem_NextManifestProgram(i);
 	}
 	
 
@@ -204,6 +306,57 @@ int OperatingSystem_LongTermScheduler() {
 }
 
 
+// Create a process from the program in the i position of programList
+// Return 1 if the process has been created, 0 else
+int OperatingSystem_AdmitProgram(int i) {
+	int PID;
+
+	if (programList[i]->type == DAEMONPROGRAM)
+		PID=OperatingSystem_CreateProcess(i, DAEMONSQUEUE);
+	else
+		PID=OperatingSystem_CreateProcess(i, USERPROCESSQUEUE);
+
+	switch (PID)
+	{
+	case NOFREEENTRY:
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(103, ERROR, programList[i] -> executableName);
+		break;
+	case PROGRAMDOESNOTEXIST:
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(104, ERROR, programList[i] -> executableName, "it does not exist");
+		break;
+	case PROGRAMNOTVALID:
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(104, ERROR, programList[i] -> executableName, "invalid priority or size");
+		break;
+	case TOOBIGPROCESS:
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(105, ERROR, programList[i] -> executableName);
+		break;
+	case MEMORYFULL:
+		// The program may wait in the pending admission queue for a partition
+		if (OperatingSystem_DeferAdmission(i) == SUCCESS)
+			break;
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(144, ERROR, programList[i] -> executableName);
+		break;
+	case NOTSCHEDULABLE:
+		// Admission control: the real-time processes would use more than the whole processor
+		OperatingSystem_ShowTime(ERROR);
+		ComputerSystem_DebugMessage(175, ERROR, programList[i] -> executableName, realTimeUtilization);
+		break;
+	default:
+		if (programList[i]->type==USERPROGRAM) 
+			numberOfNotTerminatedUserProcesses++;
+		// Move process to the ready state
+		OperatingSystem_MoveToTheREADYState(PID);
+		return 1;
+	}
+	return 0;
+}
+
+
 // This function creates a process from an executable program
 int OperatingSystem_CreateProcess(int indexOfExecutableProgram, int queueId) {
   
@@ -212,7 +365,10 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram, int queueId) {
 	int loadingPhysicalAddress;
 	int priority;
 	int program;
+	int codeSize;
 	int partitionIndex;
+	int realTime, relativeDeadline, period, executionTime;
+	long programOffset;
 	FILE *programFile;
 	PROGRAMS_DATA *executableProgram=programList[indexOfExecutableProgram];
 
@@ -240,6 +396,17 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram, int queueId) {
 	if (priority == PROGRAMNOTVALID) {
 		return PROGRAMNOTVALID;
 	}
+
+	// Obtain the real-time parameters, if any, and check the real-time processes
+	// still fit in the processor
+	realTime=OperatingSystem_ObtainRealTimeParameters(programFile, processSize, &relativeDeadline, &period, &executionTime);
+	if (realTime == PROGRAMNOTVALID)
+		return PROGRAMNOTVALID;
+	if (realTime == YES && queueId == USERPROCESSQUEUE) {
+		if (realTimeUtilization + (double) executionTime/period > 1.0 + 1e-9)
+			return NOTSCHEDULABLE;
+		queueId=REALTIMEQUEUE;
+	}
 	
 	OperatingSystem_ShowTime(SYSMEM);
 	ComputerSystem_DebugMessage(142,SYSMEM,PID,programList[indexOfExecutableProgram]->executableName, processSize);
@@ -247,6 +414,10 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram, int queueId) {
 	// Obtain enough memory space
  	partitionIndex=OperatingSystem_ObtainMainMemory(processSize, PID);
 
+	// The medium-term scheduler makes room swapping out sleeping processes
+	while (partitionIndex == MEMORYFULL && OperatingSystem_SwapOutSleeper(processSize) == SUCCESS)
+		partitionIndex=OperatingSystem_ObtainMainMemory(processSize, PID);
+
 	// Check if the program size is valid
 	switch (partitionIndex) {
 		case TOOBIGPROCESS:
@@ -259,14 +430,29 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram, int queueId) {
 	}
 
 	// Load program in the allocated memory
+	programOffset = ftell(programFile);
 	program = OperatingSystem_LoadProgram(programFile, loadingPhysicalAddress, processSize);
 
 	// Check if the number of instructions is valid
 	if (program == TOOBIGPROCESS)
 		return TOOBIGPROCESS;
+	// The loader leaves the MAR after the last instruction
+	codeSize=Processor_GetMAR()-loadingPhysicalAddress;
+	Profiler_ProgramLoaded(executableProgram->executableName, programOffset, loadingPhysicalAddress);
 	
 	// PCB initialization
 	OperatingSystem_PCBInitialization(PID, loadingPhysicalAddress, processSize, priority, indexOfExecutableProgram, queueId, partitionIndex);
+	// The user stack, at the top of the memory of the process, can not grow over its code
+	processTable[PID].stackLimit=processTable[PID].copyOfSPRegister-processSize+codeSize;
+	if (queueId == REALTIMEQUEUE) {
+		processTable[PID].relativeDeadline=relativeDeadline;
+		processTable[PID].period=period;
+		processTable[PID].executionTime=executionTime;
+		realTimeUtilization+=(double) executionTime/period;
+		OperatingSystem_ShowTime(SYSPROC);
+		ComputerSystem_DebugMessage(176,SYSPROC,PID,executableProgram->executableName,relativeDeadline,period,executionTime);
+		OperatingSystem_ReleaseJob(PID, numberOfClockInterrupts);
+	}
 	
 	// Show message "Process [PID] created from program [executableName]\n"
 	OperatingSystem_ShowTime(INIT);
@@ -316,6 +502,9 @@ void OperatingSystem_ReleaseMainMemory() {
 		partitionsTable[partitionIndex].size,executingProcessID,programList[processTable[executingProcessID].programListIndex]->executableName);
 
 	OperatingSystem_ShowPartitionTable("after releasing memory");
+
+	// The programs waiting for memory may fit now
+	OperatingSystem_RetryAdmissions();
 }
 
 
@@ -333,14 +522,34 @@ void OperatingSystem_PCBInitialization(int PID, int initialPhysicalAddress, int
 		processTable[PID].copyOfPCRegister=initialPhysicalAddress;
 		processTable[PID].copyOfPSWRegister= ((unsigned int) 1) << EXECUTION_MODE_BIT;
 		processTable[PID].copyOfAccumulatorRegister = 0;
+		processTable[PID].copyOfSPRegister=initialPhysicalAddress+processSize;
 	} 
 	else {
 		processTable[PID].copyOfPCRegister=0;
 		processTable[PID].copyOfPSWRegister=0;
 		processTable[PID].copyOfAccumulatorRegister = 0;
+		// The user stack starts empty at the top of the memory of the process
+		processTable[PID].copyOfSPRegister=processSize;
 	}
+	processTable[PID].copyOfRegisterA=0;
+	processTable[PID].copyOfRegisterB=0;
+	processTable[PID].level=0;
+	processTable[PID].quantumUsed=0;
+	// A new process starts with the least virtual runtime in the system
+	processTable[PID].vruntime=cfsMinVruntime;
+	// The PID may belong to a process whose context is still in the processor
+	if (processorContextPID==PID)
+		processorContextPID=NOPROCESS;
 	processTable[PID].queueID=queueId;
 	processTable[PID].partitionIndex=partitionIndex;
+	processTable[PID].creationTime=Clock_GetTime();
+	processTable[PID].firstDispatchTime=-1;
+	processTable[PID].lastStateChangeTime=processTable[PID].creationTime;
+	processTable[PID].cpuTics=0;
+	processTable[PID].readyTics=0;
+	processTable[PID].sleepingTics=0;
+	processTable[PID].numberOfContextSwitches=0;
+	processTable[PID].terminationTime=-1;
 	partitionsTable[partitionIndex].PID=PID;
 	OperatingSystem_ShowTime(SYSMEM);
 	ComputerSystem_DebugMessage(143,SYSMEM,partitionIndex,partitionsTable[partitionIndex].initAddress,
@@ -356,7 +565,10 @@ void OperatingSystem_PCBInitialization(int PID, int initialPhysicalAddress, int
 void OperatingSystem_MoveToTheREADYState(int PID) {
 	int previousState;
 
-	if (Heap_add(PID, readyToRunQueue[processTable[PID].queueID],QUEUE_PRIORITY ,&numberOfReadyToRunProcesses[processTable[PID].queueID] ,PROCESSTABLEMAXSIZE)>=0) {
+	// The virtual runtime of a process leaving the processor must be up to date
+	// before the process is placed in its queue
+	OperatingSystem_AccountStateTime(PID);
+	if (schedulers[schedulingPolicy].enqueue(PID)>=0) {
 		previousState = processTable[PID].state;
 		processTable[PID].state=READY;
 		OperatingSystem_ShowTime(SYSPROC);
@@ -372,6 +584,7 @@ void OperatingSystem_MoveToTheBlockedState(int PID) {
 	
 	if (Heap_add(PID,sleepingProcessesQueue,QUEUE_WAKEUP,&numberOfSleepingProcesses,PROCESSTABLEMAXSIZE) >= 0) {
 		previousState = processTable[PID].state;
+		OperatingSystem_AccountStateTime(PID);
 		processTable[PID].state = BLOCKED;
 		OperatingSystem_ShowTime(SYSPROC);
 		ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex] -> executableName, statesNames[previousState], statesNames[3]);
@@ -389,7 +602,7 @@ int OperatingSystem_ShortTermScheduler() {
 	int i;
 
 	for (i = 0; i < NUMBEROFQUEUES; i++) {
-		selectedProcess=OperatingSystem_ExtractFromReadyToRun(i);
+		selectedProcess=OperatingSystem_ExtractFromReadyToRun(schedulingOrder[i]);
 		if (selectedProcess != NOPROCESS)
 			return selectedProcess;
 	}
@@ -403,7 +616,7 @@ int OperatingSystem_ExtractFromReadyToRun(int queueId) {
   
 	int selectedProcess=NOPROCESS;
 
-	selectedProcess=Heap_poll(readyToRunQueue[queueId],QUEUE_PRIORITY ,&numberOfReadyToRunProcesses[queueId]);
+	selectedProcess=schedulers[schedulingPolicy].dequeue(queueId);
 	
 	// Return most priority process or NOPROCESS if empty queue
 	return selectedProcess; 
@@ -426,35 +639,63 @@ void OperatingSystem_Dispatch(int PID) {
 	// The process identified by PID becomes the current executing process
 	executingProcessID=PID;
 	previousState = processTable[PID].state;
+	OperatingSystem_AccountStateTime(PID);
+	if (processTable[PID].firstDispatchTime<0)
+		processTable[PID].firstDispatchTime=Clock_GetTime();
+	processTable[PID].numberOfContextSwitches++;
+	// A round-robin time quantum starts every time the process gets the processor
+	if (schedulingPolicy!=SCHEDULER_MLFQ)
+		processTable[PID].quantumUsed=0;
 	// Change the process' state
 	processTable[PID].state=EXECUTING;
 	OperatingSystem_ShowTime(SYSPROC);
 	ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex] -> executableName, statesNames[previousState], statesNames[2]);
-	// Modify hardware registers with appropriate values for the process identified by PID
-	OperatingSystem_RestoreContext(PID);
+	// A process redispatched after being preempted still has its context in the
+	// processor: it is neither saved nor restored
+	if (PID==unsavedContextPID) {
+		unsavedContextPID=NOPROCESS;
+		return;
+	}
+	if (unsavedContextPID!=NOPROCESS) {
+		OperatingSystem_SaveContext(unsavedContextPID);
+		unsavedContextPID=NOPROCESS;
+	}
+	// Modify hardware registers with appropriate values for the process identified by PID,
+	// unless the processor still holds them because the process has just left it
+	if (PID!=processorContextPID)
+		OperatingSystem_RestoreContext(PID);
 }
 
 
 // Modify hardware registers with appropriate values for the process identified by PID
 void OperatingSystem_RestoreContext(int PID) {
+	REGISTERFILE registers;
   
-	// New values for the CPU registers are obtained from the PCB
-	Processor_CopyInSystemStack(MAINMEMORYSIZE-1,processTable[PID].copyOfPCRegister);
-	Processor_CopyInSystemStack(MAINMEMORYSIZE-2,processTable[PID].copyOfPSWRegister);
-	Processor_CopyInSystemStack(MAINMEMORYSIZE-3,processTable[PID].copyOfAccumulatorRegister);
-	Processor_SetAccumulator(processTable[PID].copyOfAccumulatorRegister);
+	// New values for the CPU registers are obtained from the PCB and loaded
+	// by the processor in a single operation
+	registers.PC=processTable[PID].copyOfPCRegister;
+	registers.PSW=processTable[PID].copyOfPSWRegister;
+	registers.accumulator=processTable[PID].copyOfAccumulatorRegister;
+	registers.registerA=processTable[PID].copyOfRegisterA;
+	registers.registerB=processTable[PID].copyOfRegisterB;
+	registers.stackPointer=processTable[PID].copyOfSPRegister;
+	registers.stackLimit=processTable[PID].stackLimit;
+	Processor_RestoreRegisterFile(&registers);
 	
 	// Same thing for the MMU registers
 	MMU_SetBase(processTable[PID].initialPhysicalAddress);
 	MMU_SetLimit(processTable[PID].processSize);
+
+	processorContextPID=PID;
 }
 
 
 // Function invoked when the executing process leaves the CPU 
 void OperatingSystem_PreemptRunningProcess() {
 
-	// Save in the process' PCB essential values stored in hardware registers and the system stack
-	OperatingSystem_SaveContext(executingProcessID);
+	// Its context is saved in its PCB by the next dispatch, if the process
+	// selected is another one
+	unsavedContextPID=executingProcessID;
 	// Change the process' state
 	OperatingSystem_MoveToTheREADYState(executingProcessID);
 	// The processor is not assigned until the OS selects another process
@@ -464,16 +705,19 @@ void OperatingSystem_PreemptRunningProcess() {
 
 // Save in the process' PCB essential values stored in hardware registers and the system stack
 void OperatingSystem_SaveContext(int PID) {
-	
-	// Load PC saved for interrupt manager
-	processTable[PID].copyOfPCRegister=Processor_CopyFromSystemStack(MAINMEMORYSIZE-1);
-	
-	// Load PSW saved for interrupt manager
-	processTable[PID].copyOfPSWRegister=Processor_CopyFromSystemStack(MAINMEMORYSIZE-2);
-
-	// Load Accumulator saved for interrupt manager 
-	processTable[PID].copyOfAccumulatorRegister = Processor_CopyFromSystemStack(MAINMEMORYSIZE - 3);
-	
+	REGISTERFILE registers;
+
+	// PC, PSW and accumulator saved for interrupt manager and the general
+	// purpose registers, obtained from the processor in a single operation
+	Processor_SaveRegisterFile(&registers);
+	processTable[PID].copyOfPCRegister=registers.PC;
+	processTable[PID].copyOfPSWRegister=registers.PSW;
+	processTable[PID].copyOfAccumulatorRegister=registers.accumulator;
+	processTable[PID].copyOfRegisterA=registers.registerA;
+	processTable[PID].copyOfRegisterB=registers.registerB;
+	processTable[PID].copyOfSPRegister=registers.stackPointer;
+
+	processorContextPID=PID;
 }
 
 
@@ -517,15 +761,26 @@ void OperatingSystem_TerminateProcess() {
 	int previousState;
   	
 	previousState = processTable[executingProcessID].state;
+	OperatingSystem_AccountStateTime(executingProcessID);
 	processTable[executingProcessID].state=EXIT;
+	processTable[executingProcessID].terminationTime=Clock_GetTime();
+	OperatingSystem_AccountProcess(executingProcessID);
+	Cache_PrintProcessReport(executingProcessID, SYSPROC);
 	OperatingSystem_ShowTime(SYSPROC);
 	ComputerSystem_DebugMessage(110, SYSPROC, executingProcessID, programList[processTable[executingProcessID].programListIndex] -> executableName, statesNames[previousState], statesNames[4]);
 	
-	OperatingSystem_ReleaseMainMemory();
+	// The last job of a real-time process ends and its utilization is released
+	if (processTable[executingProcessID].queueID==REALTIMEQUEUE) {
+		OperatingSystem_CheckDeadline(executingProcessID);
+		realTimeUtilization-=(double) processTable[executingProcessID].executionTime/processTable[executingProcessID].period;
+	}
 
 	if (programList[processTable[executingProcessID].programListIndex]->type==USERPROGRAM) 
 		// One more user process that has terminated
 		numberOfNotTerminatedUserProcesses--;
+
+	// Last, because a pending program admitted now can reuse the PCB
+	OperatingSystem_ReleaseMainMemory();
 	
 	if (numberOfNotTerminatedUserProcesses==0 && OperatingSystem_IsThereANewProgram() == EMPTYQUEUE && numberOfSleepingProcesses <= 0) {
 		if (executingProcessID==sipID) {
@@ -551,6 +806,7 @@ void OperatingSystem_HandleSystemCall() {
 	int systemCallID;
 	int PID;
 	int queueId;
+	int device;
 
 	// Register A contains the identifier of the issued system call
 	systemCallID=Processor_GetRegisterA();
@@ -572,10 +828,11 @@ void OperatingSystem_HandleSystemCall() {
 
 		case SYSCALL_YIELD:
 			queueId= processTable[executingProcessID].queueID;
-			PID = readyToRunQueue[queueId][0].info;
-			if(numberOfReadyToRunProcesses[queueId] > 0) {
-				// Check new process has the same priority
-				if (processTable[executingProcessID].priority == processTable[PID].priority) {
+			PID = schedulers[schedulingPolicy].peek(queueId);
+			if(PID != NOPROCESS) {
+				// Check the scheduling policy (the same key out of the user queue) lets the process yield
+				if (queueId == USERPROCESSQUEUE ? schedulers[schedulingPolicy].yield(PID)
+					: OperatingSystem_PriorityYield(PID)) {
 					//Show message Process [oldPid] will transfer the control of the processor to process [PID]
 					OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 					ComputerSystem_DebugMessage(115, SHORTTERMSCHEDULE, executingProcessID, programList[processTable[executingProcessID].programListIndex]->executableName,
@@ -590,7 +847,11 @@ void OperatingSystem_HandleSystemCall() {
 			break;
 
 		case SYSCALL_SLEEP:
-			processTable[executingProcessID].whenToWakeUp = abs(Processor_GetAccumulator()) + numberOfClockInterrupts + 1;
+			// A real-time process sleeps until the release of its next job
+			if (processTable[executingProcessID].queueID == REALTIMEQUEUE)
+				processTable[executingProcessID].whenToWakeUp = OperatingSystem_CompleteJob(executingProcessID);
+			else
+				processTable[executingProcessID].whenToWakeUp = abs(Processor_GetAccumulator()) + numberOfClockInterrupts + 1;
 			OperatingSystem_SaveContext(executingProcessID);
 			OperatingSystem_MoveToTheBlockedState(executingProcessID);
 			PID = OperatingSystem_ShortTermScheduler();
@@ -598,6 +859,26 @@ void OperatingSystem_HandleSystemCall() {
 			OperatingSystem_PrintStatus();
 			break;
 
+		case SYSCALL_IOREAD:
+		case SYSCALL_IOWRITE:
+			// The process waits for the device while others use the processor
+			device = (systemCallID == SYSCALL_IOREAD) ? INPUTDEVICE : OUTPUTDEVICE;
+			// A request the device does not queue would never end: the process is terminated
+			if (OperatingSystem_StartIO(device, Processor_GetAccumulator()) == NO) {
+				OperatingSystem_ShowTime(INTERRUPT);
+				ComputerSystem_DebugMessage(198,INTERRUPT,executingProcessID,
+					programList[processTable[executingProcessID].programListIndex]->executableName,deviceNames[DEVICEINDEX(device)]);
+				OperatingSystem_TerminateProcess();
+				OperatingSystem_PrintStatus();
+				break;
+			}
+			OperatingSystem_SaveContext(executingProcessID);
+			OperatingSystem_MoveToTheDeviceQueue(executingProcessID, device);
+			PID = OperatingSystem_ShortTermScheduler();
+			OperatingSystem_Dispatch(PID);
+			OperatingSystem_PrintStatus();
+			break;
+
 		default:
 			OperatingSystem_ShowTime(INTERRUPT);
 			ComputerSystem_DebugMessage(141,INTERRUPT,executingProcessID,
@@ -610,6 +891,9 @@ void OperatingSystem_HandleSystemCall() {
 	
 //	Implement interrupt logic calling appropriate interrupt handle
 void OperatingSystem_InterruptLogic(int entryPoint){
+	HOOK_BEFORE_INTERRUPTLOGIC();
+	// The system stack holds the context of the interrupted program, not a saved one
+	processorContextPID=NOPROCESS;
 	switch (entryPoint){
 		case SYSCALL_BIT: // SYSCALL_BIT=2
 			OperatingSystem_HandleSystemCall();
@@ -620,6 +904,12 @@ void OperatingSystem_InterruptLogic(int entryPoint){
 		case CLOCKINT_BIT: //CLOCKINT_BIT=9
 			OperatingSystem_HandleClockInterrupt();
 			break;
+		case IOEND_BIT: // IOEND_BIT=8
+			OperatingSystem_HandleIOEndInterrupt();
+			break;
+		case DMAEND_BIT: // DMAEND_BIT=7
+			OperatingSystem_HandleDMAEndInterrupt();
+			break;
 	}
 
 }
@@ -630,6 +920,18 @@ void OperatingSystem_PrintReadyToRunQueue() {
 	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 	ComputerSystem_DebugMessage(106, SHORTTERMSCHEDULE);
 
+	if (numberOfReadyToRunProcesses[REALTIMEQUEUE] > 0) {
+		ComputerSystem_DebugMessage(174, SHORTTERMSCHEDULE);
+		for (i = 0; i < numberOfReadyToRunProcesses[REALTIMEQUEUE]; i++) {
+			if (i == numberOfReadyToRunProcesses[REALTIMEQUEUE] - 1)
+				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[REALTIMEQUEUE][i],
+					OperatingSystem_SchedulingKey(readyToRunQueue[REALTIMEQUEUE][i].info), "\n");
+			else
+				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[REALTIMEQUEUE][i],
+					OperatingSystem_SchedulingKey(readyToRunQueue[REALTIMEQUEUE][i].info), ",");
+		}
+	}
+
 	ComputerSystem_DebugMessage(112, SHORTTERMSCHEDULE);
 	if (numberOfReadyToRunProcesses[USERPROCESSQUEUE] == 0)
 		ComputerSystem_DebugMessage(114, SHORTTERMSCHEDULE);
@@ -638,10 +940,10 @@ void OperatingSystem_PrintReadyToRunQueue() {
 		for (i = 0; i < numberOfReadyToRunProcesses[USERPROCESSQUEUE]; i++) {
 			if (i == numberOfReadyToRunProcesses[USERPROCESSQUEUE] - 1)
 				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[USERPROCESSQUEUE][i],
-					processTable[readyToRunQueue[USERPROCESSQUEUE][i].info].priority, "\n");
+					OperatingSystem_SchedulingKey(readyToRunQueue[USERPROCESSQUEUE][i].info), "\n");
 			else
 				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[USERPROCESSQUEUE][i],
-					processTable[readyToRunQueue[USERPROCESSQUEUE][i].info].priority, ",");
+					OperatingSystem_SchedulingKey(readyToRunQueue[USERPROCESSQUEUE][i].info), ",");
 		}
 	}
 
@@ -653,10 +955,10 @@ void OperatingSystem_PrintReadyToRunQueue() {
 		for (i = 0; i < numberOfReadyToRunProcesses[DAEMONSQUEUE]; i++) {
 			if (i == numberOfReadyToRunProcesses[DAEMONSQUEUE] - 1)
 				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[DAEMONSQUEUE][i],
-					processTable[readyToRunQueue[DAEMONSQUEUE][i].info].priority, "\n");
+					OperatingSystem_SchedulingKey(readyToRunQueue[DAEMONSQUEUE][i].info), "\n");
 			else
 				ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE, readyToRunQueue[DAEMONSQUEUE][i],
-					processTable[readyToRunQueue[DAEMONSQUEUE][i].info].priority, ",");
+					OperatingSystem_SchedulingKey(readyToRunQueue[DAEMONSQUEUE][i].info), ",");
 		}
 	}
 }
@@ -664,14 +966,35 @@ void OperatingSystem_PrintReadyToRunQueue() {
 void OperatingSystem_HandleClockInterrupt(){ 
 	int i, PID, createdProcesses;
 	int numberOfProcessToWakeUp = 0;
+	int interruptedPID = executingProcessID, quantumExpired;
 
 	OperatingSystem_ShowTime(INTERRUPT);
 	numberOfClockInterrupts++;
 	ComputerSystem_DebugMessage(120,INTERRUPT,numberOfClockInterrupts);
 
+	quantumExpired = schedulers[schedulingPolicy].tick(executingProcessID == sipID ? NOPROCESS : executingProcessID);
+	for (i = 0; i < PROCESSTABLEMAXSIZE; i++)
+		if (processTable[i].busy && processTable[i].queueID == REALTIMEQUEUE
+			&& (processTable[i].state == READY || processTable[i].state == EXECUTING))
+			OperatingSystem_CheckDeadline(i);
+
 	for (i = 0; i < numberOfSleepingProcesses; i++) {
 		if (processTable[sleepingProcessesQueue[i].info].whenToWakeUp == numberOfClockInterrupts) {
 			PID = OperatingSystem_ExtractFromBlocked();
+			// A swapped out process without room in memory, or one still being
+			// swapped out, tries again at the next interrupt
+			if (PID == dmaSwapOutPID || (processTable[PID].state == SWAPPED && OperatingSystem_SwapIn(PID) != SUCCESS)) {
+				processTable[PID].whenToWakeUp++;
+				Heap_add(PID,sleepingProcessesQueue,QUEUE_WAKEUP,&numberOfSleepingProcesses,PROCESSTABLEMAXSIZE);
+				i--;
+				continue;
+			}
+			// It will be ready when the DMA controller ends copying its memory
+			if (PID == dmaSwapInPID) {
+				i--;
+				continue;
+			}
+			OperatingSystem_PrepareWokenProcess(PID);
 			OperatingSystem_MoveToTheREADYState(PID);
 			numberOfProcessToWakeUp++;
 			i--;
@@ -690,19 +1013,35 @@ void OperatingSystem_HandleClockInterrupt(){
 			
 		OperatingSystem_CheckIfIsNecessaryToChangeProcess();
 	}
+
+	// A process that has used its whole quantum leaves the processor to the
+	// first ready process of its priority (or level), or a better one
+	if (quantumExpired && executingProcessID == interruptedPID)
+		OperatingSystem_RotateExecutingProcess();
 } 
 
 void OperatingSystem_CheckIfIsNecessaryToChangeProcess() {
 	int PIDWithMaxPriority;
 
-	if (numberOfReadyToRunProcesses[USERPROCESSQUEUE] > 0) {
-		PIDWithMaxPriority = Heap_getFirst(readyToRunQueue[USERPROCESSQUEUE], numberOfReadyToRunProcesses[USERPROCESSQUEUE]);
-		if (processTable[PIDWithMaxPriority].priority < processTable[executingProcessID].priority || processTable[executingProcessID].queueID == DAEMONSQUEUE) {
+	// The earliest deadline preempts any other process
+	if (numberOfReadyToRunProcesses[REALTIMEQUEUE] > 0) {
+		PIDWithMaxPriority = schedulers[schedulingPolicy].peek(REALTIMEQUEUE);
+		if (processTable[executingProcessID].queueID != REALTIMEQUEUE || OperatingSystem_SchedulingKey(PIDWithMaxPriority) < OperatingSystem_SchedulingKey(executingProcessID))
+			OperatingSystem_ChangeProcess(PIDWithMaxPriority);
+	} else if (processTable[executingProcessID].queueID == REALTIMEQUEUE)
+		return;
+	else if (numberOfReadyToRunProcesses[USERPROCESSQUEUE] > 0) {
+		PIDWithMaxPriority = schedulers[schedulingPolicy].peek(USERPROCESSQUEUE);
+		// Under CFS, a user process keeps the processor for its minimum granularity
+		// even if a process with less virtual runtime wakes up
+		if ((OperatingSystem_SchedulingKey(PIDWithMaxPriority) < OperatingSystem_SchedulingKey(executingProcessID)
+				&& (schedulingPolicy != SCHEDULER_CFS || processTable[executingProcessID].quantumUsed >= cfsGranularity))
+			|| processTable[executingProcessID].queueID == DAEMONSQUEUE) {
 			OperatingSystem_ChangeProcess(PIDWithMaxPriority);
 		}
 	} else if (processTable[executingProcessID].queueID != USERPROCESSQUEUE) {
-		PIDWithMaxPriority = Heap_getFirst(readyToRunQueue[DAEMONSQUEUE], numberOfReadyToRunProcesses[DAEMONSQUEUE]);
-		if (processTable[PIDWithMaxPriority].priority < processTable[executingProcessID].priority)
+		PIDWithMaxPriority = schedulers[schedulingPolicy].peek(DAEMONSQUEUE);
+		if (OperatingSystem_SchedulingKey(PIDWithMaxPriority) < OperatingSystem_SchedulingKey(executingProcessID))
 			OperatingSystem_ChangeProcess(PIDWithMaxPriority);
 	}
 	
@@ -720,4 +1059,959 @@ void OperatingSystem_ChangeProcess(int PID) {
 
 int OperatingSystem_GetExecutingProcessID() {
 	return executingProcessID;
-}
\ No newline at end of file
+}
+
+// When only the System Idle Process can use the processor, the clock interrupts
+// that neither wake up a sleeping process nor admit a new program change nothing
+// but the time. They are skipped, leaving the machine in the same state it would
+// have reached executing the SIP loop and the clock interrupt handler
+void OperatingSystem_FastForwardIdle() {
+	int currentTime, nextInterruptTime, limitTime, assertTime;
+	int periods=0, sipInstructions=0, skippedTics, PC;
+
+	// A device serving requests or the DMA controller will interrupt the idle time
+	if (executingProcessID!=sipID || intervalBetweenInterrupts<=3 || Device_IsBusy() || DMA_IsBusy())
+		return;
+
+	// The profiler counts every executed instruction and the caches see every
+	// fetch and pay its misses, so nothing can be skipped
+	if (profile || Cache_IsEnabled())
+		return;
+
+	// The simulation can not jump over a checkpoint, an assert or its end time
+	limitTime=checkpointTime;
+	if (endSimulationTime>=0 && (limitTime<0 || endSimulationTime<limitTime))
+		limitTime=endSimulationTime;
+	assertTime=Asserts_NextAssertTime();
+	if (assertTime>=0 && (limitTime<0 || assertTime<limitTime))
+		limitTime=assertTime;
+
+	// Each period: the SIP runs until the clock interrupt is raised, then
+	// OS 9 (1 tic), the clock interrupt handler (1 tic) and IRET (1 tic)
+	currentTime=Clock_GetTime();
+	nextInterruptTime=(currentTime/intervalBetweenInterrupts+1)*intervalBetweenInterrupts;
+	while ((limitTime<0 || nextInterruptTime+3<limitTime)
+		&& !OperatingSystem_IsInterestingClockInterrupt(numberOfClockInterrupts+periods+1, nextInterruptTime+2)) {
+		sipInstructions+=nextInterruptTime-currentTime;
+		currentTime=nextInterruptTime+3;
+		nextInterruptTime+=intervalBetweenInterrupts;
+		periods++;
+	}
+
+	if (periods==0 || !OperatingSystem_SIPIsIdle())
+		return;
+
+	// The SIP loop is NOP + JUMP -1, so only the parity of the number of
+	// executed instructions matters for its PC
+	PC=Processor_GetPC();
+	if (sipInstructions%2)
+		PC=(Processor_DecodeOperationCode(OperatingSystem_ReadPhysicalMemory(PC))==NOP_INST) ? PC+1 : PC-1;
+	Processor_SetPC(PC);
+	Processor_DeactivatePSW_Bit(OVERFLOW_BIT);
+
+	// What the last skipped clock interrupt left in the system stack
+	Processor_CopyInSystemStack(MAINMEMORYSIZE-1, PC);
+	Processor_CopyInSystemStack(MAINMEMORYSIZE-2, Processor_GetPSW());
+	Processor_CopyInSystemStack(MAINMEMORYSIZE-3, Processor_GetAccumulator());
+
+	skippedTics=currentTime-Clock_GetTime();
+	Clock_FastForward(skippedTics);
+	numberOfClockInterrupts+=periods;
+	numberOfSkippedIdleTics+=skippedTics;
+
+	OperatingSystem_ShowTime(CLOCK);
+	ComputerSystem_DebugMessage(153,CLOCK,skippedTics,periods,numberOfClockInterrupts);
+}
+
+// Returns YES if the clock interrupt number interruptNumber, handled at
+// handlerTime, will wake up a process, admit a program or shut down the system
+int OperatingSystem_IsInterestingClockInterrupt(int interruptNumber, int handlerTime) {
+	int i, indexInProgramList;
+
+	for (i=0; i<numberOfSleepingProcesses; i++)
+		if (processTable[sleepingProcessesQueue[i].info].whenToWakeUp==interruptNumber)
+			return YES;
+
+	// Aging changes the level of the sleeping processes
+	if (schedulingPolicy==SCHEDULER_MLFQ && mlfqAgingInterval>0 && interruptNumber%mlfqAgingInterval==0)
+		return YES;
+
+	indexInProgramList=Heap_getFirst(arrivalTimeQueue,numberOfProgramsInArrivalTimeQueue);
+	if (indexInProgramList<0)
+		return numberOfNotTerminatedUserProcesses<=0 ? YES : NO;
+
+	return programList[indexInProgramList]->arrivalTime<=handlerTime ? YES : NO;
+}
+
+// Returns YES if the SIP is inside its NOP + JUMP -1 loop
+int OperatingSystem_SIPIsIdle() {
+	int PC=Processor_GetPC();
+	BUSDATACELL instruction=OperatingSystem_ReadPhysicalMemory(PC);
+
+	switch (Processor_DecodeOperationCode(instruction)) {
+		case NOP_INST:
+			instruction=OperatingSystem_ReadPhysicalMemory(PC+1);
+			break;
+		case JUMP_INST:
+			if (Processor_DecodeOperand1(instruction)!=-1)
+				return NO;
+			instruction=OperatingSystem_ReadPhysicalMemory(PC-1);
+			return Processor_DecodeOperationCode(instruction)==NOP_INST ? YES : NO;
+		default:
+			return NO;
+	}
+	return (Processor_DecodeOperationCode(instruction)==JUMP_INST && Processor_DecodeOperand1(instruction)==-1) ? YES : NO;
+}
+
+// Contents of a physical memory cell, read through the system buses
+BUSDATACELL OperatingSystem_ReadPhysicalMemory(int physicalAddress) {
+	BUSDATACELL data;
+	// The whole cell is taken from the MBR: an instruction may not fit in an int
+	Processor_CopyFromSystemStack(physicalAddress);
+	Processor_GetMBR(&data);
+	return data;
+}
+
+// Show the state of the processes, queues and partitions when the simulation is
+// stopped before all the processes have finished
+void OperatingSystem_PrintFinalState() {
+	int i, partitionsInUse=0, numberOfPartitions=0, memoryInUse=0, memorySize=0, numberOfReadyProcesses=0;
+
+	OperatingSystem_PrintStatus();
+	OperatingSystem_ShowPartitionTable("at the end of the simulation");
+
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(100,SHUTDOWN,"Process states:\n");
+	for (i=0; i<PROCESSTABLEMAXSIZE; i++)
+		if (processTable[i].busy)
+			ComputerSystem_DebugMessage(156,SHUTDOWN,i,programList[processTable[i].programListIndex]->executableName,
+				statesNames[processTable[i].state],queueNames[processTable[i].queueID],processTable[i].priority,
+				processTable[i].whenToWakeUp,processTable[i].partitionIndex);
+
+	for (i=0; i<PARTITIONTABLEMAXSIZE && partitionsTable[i].initAddress>=0; i++) {
+		numberOfPartitions++;
+		memorySize+=partitionsTable[i].size;
+		if (partitionsTable[i].PID!=NOPROCESS) {
+			partitionsInUse++;
+			memoryInUse+=partitionsTable[i].size;
+		}
+	}
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(157,SHUTDOWN,partitionsInUse,numberOfPartitions,memoryInUse,memorySize);
+	for (i=0; i<NUMBEROFQUEUES; i++)
+		numberOfReadyProcesses+=numberOfReadyToRunProcesses[i];
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(158,SHUTDOWN,numberOfReadyProcesses,
+		numberOfSleepingProcesses,numberOfProgramsInArrivalTimeQueue);
+}
+
+// Add the time since the last state change of a process to the time
+// it has spent in its current state
+void OperatingSystem_AccountStateTime(int PID) {
+	int now=Clock_GetTime();
+	int elapsed=now-processTable[PID].lastStateChangeTime;
+
+	switch (processTable[PID].state) {
+		case READY:
+			processTable[PID].readyTics+=elapsed;
+			break;
+		case EXECUTING:
+			processTable[PID].cpuTics+=elapsed;
+			if (schedulingPolicy==SCHEDULER_CFS)
+				processTable[PID].vruntime+=elapsed*(processTable[PID].priority+1);
+			break;
+		case BLOCKED:
+		case SWAPPED:
+			processTable[PID].sleepingTics+=elapsed;
+			break;
+	}
+	processTable[PID].lastStateChangeTime=now;
+}
+
+// Add a finished (or still alive at shutdown) process to the scheduling
+// metrics and write its line in the accounting CSV file
+void OperatingSystem_AccountProcess(int PID) {
+	PCB *pcb=&processTable[PID];
+	PROGRAMS_DATA *program=programList[pcb->programListIndex];
+	int turnaround=-1, response=-1;
+
+	if (accountingFile==NULL)
+		return;
+
+	if (accountingCSV==NULL) {
+		accountingCSV=fopen(accountingFile, "w");
+		if (accountingCSV==NULL) {
+			OperatingSystem_ShowTime(ERROR);
+			ComputerSystem_DebugMessage(159,ERROR,accountingFile);
+			accountingFile=NULL;
+			return;
+		}
+		fprintf(accountingCSV,"PID,program,type,priority,arrivalTime,creationTime,firstDispatchTime,terminationTime,"
+			"cpuTics,readyTics,sleepingTics,contextSwitches,turnaround,response,waiting\n");
+	}
+
+	if (pcb->terminationTime>=0)
+		turnaround=pcb->terminationTime-pcb->creationTime;
+	if (pcb->firstDispatchTime>=0)
+		response=pcb->firstDispatchTime-pcb->creationTime;
+
+	fprintf(accountingCSV,"%d,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+		PID,program->executableName,queueNames[pcb->queueID],pcb->priority,program->arrivalTime,
+		pcb->creationTime,pcb->firstDispatchTime,pcb->terminationTime,
+		pcb->cpuTics,pcb->readyTics,pcb->sleepingTics,pcb->numberOfContextSwitches,
+		turnaround,response,pcb->readyTics);
+
+	if (PID==sipID)
+		accountingTotals.idleTics+=pcb->cpuTics;
+	else if (pcb->terminationTime>=0) {
+		// Averages only consider the processes that have finished
+		accountingTotals.numberOfProcesses++;
+		accountingTotals.sumTurnaround+=turnaround;
+		accountingTotals.sumResponse+=response;
+		accountingTotals.sumWaiting+=pcb->readyTics;
+	}
+	accountingTotals.sumCpuTics+=pcb->cpuTics;
+	accountingTotals.numberOfContextSwitches+=pcb->numberOfContextSwitches;
+}
+
+// Show the scheduling metrics at shutdown: average turnaround, response and
+// waiting times of the finished processes and CPU utilization
+void OperatingSystem_PrintAccountingReport() {
+	int i, n;
+	double utilization=0;
+
+	if (accountingFile==NULL)
+		return;
+
+	// Processes that have not finished are also written in the CSV file
+	for (i=0; i<PROCESSTABLEMAXSIZE; i++)
+		if (processTable[i].busy && processTable[i].state!=EXIT) {
+			OperatingSystem_AccountStateTime(i);
+			OperatingSystem_AccountProcess(i);
+		}
+	if (accountingCSV!=NULL)
+		fclose(accountingCSV);
+
+	n=accountingTotals.numberOfProcesses;
+	if (Clock_GetTime()>0)
+		utilization=(double) (Clock_GetTime()-accountingTotals.idleTics)/Clock_GetTime();
+
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(160,SHUTDOWN,accountingFile);
+	ComputerSystem_DebugMessage(161,SHUTDOWN,n,accountingTotals.numberOfContextSwitches);
+	ComputerSystem_DebugMessage(162,SHUTDOWN,
+		n>0 ? (double) accountingTotals.sumTurnaround/n : 0.0,
+		n>0 ? (double) accountingTotals.sumResponse/n : 0.0,
+		n>0 ? (double) accountingTotals.sumWaiting/n : 0.0);
+	ComputerSystem_DebugMessage(163,SHUTDOWN,Clock_GetTime()-accountingTotals.idleTics,Clock_GetTime(),utilization);
+}
+
+// Value that orders the processes in their ready-to-run queue: the lower, the
+// sooner the process is selected. User processes are ordered by the key of the
+// scheduling policy, real-time processes by the absolute deadline of their
+// current job and daemons by their priority
+int OperatingSystem_SchedulingKey(int PID) {
+	if (processTable[PID].queueID==REALTIMEQUEUE)
+		return processTable[PID].absoluteDeadline;
+	if (processTable[PID].queueID==USERPROCESSQUEUE)
+		return schedulers[schedulingPolicy].key(PID);
+	return processTable[PID].priority;
+}
+
+// Parse the value of the --mlfq option: quantum,quantum,...[:aging], with the
+// quantum (in clock interrupts) of every level, from the highest one, and the
+// clock interrupts between two agings. Return INVALIDOPTION if it is not valid
+int OperatingSystem_ParseMLFQOption(char *optionValue) {
+	char value[MAXLINELENGTH];
+	char *quanta, *aging, *token;
+	int quantum;
+
+	strncpy(value, optionValue!=NULL ? optionValue : MLFQDEFAULTOPTION, MAXLINELENGTH-1);
+	value[MAXLINELENGTH-1]=0;
+	quanta=strtok(value,":");
+	aging=strtok(NULL,"");
+
+	mlfqLevels=0;
+	mlfqAgingInterval=0;
+	for (token=strtok(quanta,","); token!=NULL; token=strtok(NULL,",")) {
+		if (mlfqLevels==MLFQMAXLEVELS || sscanf(token,"%d",&quantum)!=1 || quantum<=0)
+			return INVALIDOPTION;
+		mlfqQuantum[mlfqLevels++]=quantum;
+	}
+	if (mlfqLevels==0 || (aging!=NULL && (sscanf(aging,"%d",&mlfqAgingInterval)!=1 || mlfqAgingInterval<0)))
+		return INVALIDOPTION;
+
+	schedulingPolicy=SCHEDULER_MLFQ;
+	return SUCCESS;
+}
+
+// Ready-to-run queues of every scheduling policy: binary heaps ordered by
+// OperatingSystem_SchedulingKey
+int OperatingSystem_HeapEnqueue(int PID) {
+	return Heap_add(PID, readyToRunQueue[processTable[PID].queueID], QUEUE_PRIORITY,
+		&numberOfReadyToRunProcesses[processTable[PID].queueID], PROCESSTABLEMAXSIZE);
+}
+
+int OperatingSystem_HeapDequeue(int queueId) {
+	return Heap_poll(readyToRunQueue[queueId], QUEUE_PRIORITY, &numberOfReadyToRunProcesses[queueId]);
+}
+
+int OperatingSystem_HeapPeek(int queueId) {
+	return Heap_getFirst(readyToRunQueue[queueId], numberOfReadyToRunProcesses[queueId]);
+}
+
+// Priority scheduling: with --quantum, processes of equal priority are time sliced
+int OperatingSystem_PriorityTick(int PID) {
+	if (PID==NOPROCESS || roundRobinQuantum<=0 || ++processTable[PID].quantumUsed < roundRobinQuantum)
+		return NO;
+	processTable[PID].quantumUsed=0;
+	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+	ComputerSystem_DebugMessage(172,SHORTTERMSCHEDULE,PID,
+		programList[processTable[PID].programListIndex]->executableName,roundRobinQuantum);
+	return YES;
+}
+
+// The processor is only yielded to a process with the same key (priority or level)
+int OperatingSystem_PriorityYield(int PID) {
+	return OperatingSystem_SchedulingKey(executingProcessID)==OperatingSystem_SchedulingKey(PID) ? YES : NO;
+}
+
+void OperatingSystem_PriorityWake(int PID) {
+}
+
+int OperatingSystem_PriorityKey(int PID) {
+	return processTable[PID].priority;
+}
+
+// Multi-level feedback queue: a user process that uses its whole quantum is
+// demoted, and every mlfqAgingInterval clock interrupts all of them are aged
+int OperatingSystem_MLFQTick(int PID) {
+	int quantumExpired=NO;
+
+	if (PID!=NOPROCESS && processTable[PID].queueID==USERPROCESSQUEUE
+		&& ++processTable[PID].quantumUsed >= mlfqQuantum[processTable[PID].level]) {
+		quantumExpired=YES;
+		processTable[PID].quantumUsed=0;
+		if (processTable[PID].level < mlfqLevels-1) {
+			processTable[PID].level++;
+			OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+			ComputerSystem_DebugMessage(169,SHORTTERMSCHEDULE,PID,
+				programList[processTable[PID].programListIndex]->executableName,processTable[PID].level);
+		}
+	}
+	if (mlfqAgingInterval > 0 && numberOfClockInterrupts % mlfqAgingInterval == 0)
+		OperatingSystem_MLFQAging();
+	return quantumExpired;
+}
+
+// A user process that returns from SYSCALL_SLEEP goes up a level with a new quantum
+void OperatingSystem_MLFQWake(int PID) {
+	processTable[PID].quantumUsed=0;
+	if (processTable[PID].level>0) {
+		processTable[PID].level--;
+		OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+		ComputerSystem_DebugMessage(170,SHORTTERMSCHEDULE,PID,
+			programList[processTable[PID].programListIndex]->executableName,processTable[PID].level);
+	}
+}
+
+int OperatingSystem_MLFQKey(int PID) {
+	return processTable[PID].level;
+}
+
+// Periodic aging: every user process goes back to the highest level, so the
+// ones demoted to the lowest levels do not starve
+void OperatingSystem_MLFQAging() {
+	int i, numberOfReadyProcesses=0;
+	int readyProcesses[PROCESSTABLEMAXSIZE];
+
+	// The ready processes are queued again in the order they had
+	while (numberOfReadyToRunProcesses[USERPROCESSQUEUE]>0)
+		readyProcesses[numberOfReadyProcesses++]=OperatingSystem_ExtractFromReadyToRun(USERPROCESSQUEUE);
+
+	for (i=0; i<PROCESSTABLEMAXSIZE; i++)
+		if (processTable[i].busy && processTable[i].queueID==USERPROCESSQUEUE) {
+			processTable[i].level=0;
+			processTable[i].quantumUsed=0;
+		}
+
+	for (i=0; i<numberOfReadyProcesses; i++)
+		schedulers[schedulingPolicy].enqueue(readyProcesses[i]);
+
+	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+	ComputerSystem_DebugMessage(171,SHORTTERMSCHEDULE,numberOfClockInterrupts);
+}
+
+// Completely-fair scheduler: the virtual runtime of the executing user process
+// is brought up to date every clock interrupt. After its minimum granularity,
+// the process is checked against the least virtual runtime every interrupt
+int OperatingSystem_CFSTick(int PID) {
+	if (PID==NOPROCESS || processTable[PID].queueID!=USERPROCESSQUEUE)
+		return NO;
+	OperatingSystem_AccountStateTime(PID);
+	OperatingSystem_CFSUpdateMinVruntime();
+	return ++processTable[PID].quantumUsed >= cfsGranularity ? YES : NO;
+}
+
+// A process that yields goes behind the first ready process
+int OperatingSystem_CFSYield(int PID) {
+	if (processTable[executingProcessID].vruntime<processTable[PID].vruntime)
+		processTable[executingProcessID].vruntime=processTable[PID].vruntime;
+	return YES;
+}
+
+// A process does not save virtual runtime while it sleeps, so it can
+// not monopolize the processor when it wakes up
+void OperatingSystem_CFSWake(int PID) {
+	if (processTable[PID].vruntime>=cfsMinVruntime)
+		return;
+	processTable[PID].vruntime=cfsMinVruntime;
+	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+	ComputerSystem_DebugMessage(173,SHORTTERMSCHEDULE,PID,
+		programList[processTable[PID].programListIndex]->executableName,cfsMinVruntime);
+}
+
+int OperatingSystem_CFSKey(int PID) {
+	return processTable[PID].vruntime;
+}
+
+// Advance the minimum virtual runtime to the least one of the executing and
+// the ready user processes
+void OperatingSystem_CFSUpdateMinVruntime() {
+	int PID, minVruntime=-1;
+
+	if (executingProcessID!=NOPROCESS && processTable[executingProcessID].queueID==USERPROCESSQUEUE)
+		minVruntime=processTable[executingProcessID].vruntime;
+	PID=schedulers[schedulingPolicy].peek(USERPROCESSQUEUE);
+	if (PID!=NOPROCESS && (minVruntime<0 || processTable[PID].vruntime<minVruntime))
+		minVruntime=processTable[PID].vruntime;
+	if (minVruntime>cfsMinVruntime)
+		cfsMinVruntime=minVruntime;
+}
+
+// Select the scheduling policy of the user processes by its name (--scheduler
+// option). Return INVALIDOPTION if there is no policy with that name
+int OperatingSystem_SelectScheduler(char *name) {
+	int i;
+
+	for (i=0; name!=NULL && i<NUMBEROFSCHEDULERS; i++)
+		if (strcasecmp(schedulers[i].name, name)==0) {
+			// The multi-level feedback queue needs its levels
+			if (i==SCHEDULER_MLFQ && mlfqLevels==0)
+				OperatingSystem_ParseMLFQOption(NULL);
+			schedulingPolicy=i;
+			return SUCCESS;
+		}
+	return INVALIDOPTION;
+}
+
+// Give the processor to the first ready process of the queue of the executing
+// one if it is as good as it. The executing process goes behind the ready
+// processes with its same key
+void OperatingSystem_RotateExecutingProcess() {
+	int PID=schedulers[schedulingPolicy].peek(processTable[executingProcessID].queueID);
+
+	if (PID!=NOPROCESS && OperatingSystem_SchedulingKey(PID) <= OperatingSystem_SchedulingKey(executingProcessID))
+		OperatingSystem_ChangeProcess(PID);
+}
+
+// Scheduling changes of a process that returns from SYSCALL_SLEEP
+void OperatingSystem_PrepareWokenProcess(int PID) {
+	// A real-time process wakes up at the release of its next job
+	if (processTable[PID].queueID==REALTIMEQUEUE)
+		OperatingSystem_ReleaseJob(PID, numberOfClockInterrupts);
+	else if (processTable[PID].queueID==USERPROCESSQUEUE)
+		schedulers[schedulingPolicy].wake(PID);
+}
+
+// Read the optional real-time line of the program header, after the priority:
+// relative deadline, period and execution time, in clock interrupts. Without
+// execution time, it is the time to execute processSize instructions.
+// Return YES if the program is real-time, NO if it is not, or PROGRAMNOTVALID
+int OperatingSystem_ObtainRealTimeParameters(FILE *programFile, int processSize, int *relativeDeadline, int *period, int *executionTime) {
+	char lineRead[MAXLINELENGTH];
+	long lineOffset;
+	int fields;
+
+	do {
+		lineOffset=ftell(programFile);
+		if (fgets(lineRead, MAXLINELENGTH, programFile)==NULL)
+			return NO;
+	} while (lineRead[0]=='/' || lineRead[0]=='\n' || lineRead[0]=='\r');
+
+	// The first instruction of a program that is not real-time
+	if (!isdigit(lineRead[strspn(lineRead," ")])) {
+		fseek(programFile, lineOffset, SEEK_SET);
+		return NO;
+	}
+
+	fields=sscanf(lineRead,"%d %d %d",relativeDeadline,period,executionTime);
+	if (fields<3)
+		*executionTime=(processSize+intervalBetweenInterrupts-1)/intervalBetweenInterrupts;
+	if (fields<2 || *relativeDeadline<=0 || *period<*relativeDeadline
+		|| *executionTime<=0 || *executionTime>*relativeDeadline)
+		return PROGRAMNOTVALID;
+	return YES;
+}
+
+// A new job of a real-time process is released at clock interrupt releaseTime
+void OperatingSystem_ReleaseJob(int PID, int releaseTime) {
+	processTable[PID].absoluteDeadline=releaseTime+processTable[PID].relativeDeadline;
+	processTable[PID].nextRelease=releaseTime+processTable[PID].period;
+	processTable[PID].deadlineMissed=NO;
+	numberOfRealTimeJobs++;
+}
+
+// The current job of a real-time process ends. Return the clock interrupt at
+// which its next job is released (the next one if the period is already over)
+int OperatingSystem_CompleteJob(int PID) {
+	OperatingSystem_CheckDeadline(PID);
+	if (processTable[PID].nextRelease<=numberOfClockInterrupts)
+		processTable[PID].nextRelease=numberOfClockInterrupts+1;
+	return processTable[PID].nextRelease;
+}
+
+// Count a deadline miss if the current job of a real-time process has not
+// finished before its absolute deadline (only once per job)
+void OperatingSystem_CheckDeadline(int PID) {
+	if (processTable[PID].deadlineMissed || numberOfClockInterrupts<processTable[PID].absoluteDeadline)
+		return;
+	processTable[PID].deadlineMissed=YES;
+	numberOfDeadlineMisses++;
+	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
+	ComputerSystem_DebugMessage(177,SHORTTERMSCHEDULE,PID,
+		programList[processTable[PID].programListIndex]->executableName,processTable[PID].absoluteDeadline);
+}
+
+// Show the real-time jobs released and the deadlines missed, if there has been any
+void OperatingSystem_PrintRealTimeReport() {
+	if (numberOfRealTimeJobs==0)
+		return;
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(178,SHUTDOWN,numberOfRealTimeJobs,numberOfDeadlineMisses);
+}
+
+// Stream of the swap file, opened the first time it is needed. An existing
+// file is kept, as it holds the processes swapped out in a checkpoint
+FILE *OperatingSystem_SwapFile() {
+	if (swapStream==NULL && swapFile!=NULL) {
+		swapStream=fopen(swapFile, "r+b");
+		if (swapStream==NULL)
+			swapStream=fopen(swapFile, "w+b");
+		if (swapStream==NULL) {
+			ComputerSystem_DebugMessage(183,ERROR,swapFile);
+			swapFile=NULL;
+		}
+	}
+	return swapStream;
+}
+
+// Swap out the sleeping process that will sleep the longest among the ones
+// whose partition has room for processSize. Daemons, which use physical
+// addresses, are never swapped out. Return the result of OperatingSystem_SwapOut,
+// or NO if there is none
+int OperatingSystem_SwapOutSleeper(int processSize) {
+	int i, PID, selectedProcess=NOPROCESS;
+
+	if (swapFile==NULL)
+		return NO;
+
+	for (i=0; i<numberOfSleepingProcesses; i++) {
+		PID=sleepingProcessesQueue[i].info;
+		if (processTable[PID].state==BLOCKED && processTable[PID].queueID!=DAEMONSQUEUE && PID!=dmaSwapOutPID
+			&& processTable[PID].whenToWakeUp>numberOfClockInterrupts
+			&& partitionsTable[processTable[PID].partitionIndex].size>=processSize
+			&& (selectedProcess==NOPROCESS || processTable[PID].whenToWakeUp>processTable[selectedProcess].whenToWakeUp))
+			selectedProcess=PID;
+	}
+	if (selectedProcess==NOPROCESS)
+		return NO;
+	return OperatingSystem_SwapOut(selectedProcess);
+}
+
+// Write the memory of a sleeping process in its slot of the swap file and
+// free its partition. The DMA controller copies the partition in its buffer
+// while other processes run, and the partition is freed when it ends. If it
+// is busy, the processor copies it. Return SUCCESS if the partition is free,
+// SWAPPINGOUT if it will be at the DMA end interrupt, or NO if the swap file fails
+int OperatingSystem_SwapOut(int PID) {
+	int i;
+	MEMORYCELL cell;
+	DMA_DESCRIPTOR descriptor;
+	FILE *swap=OperatingSystem_SwapFile();
+
+	if (swap==NULL)
+		return NO;
+
+	if (!DMA_IsBusy()) {
+		descriptor.source=processTable[PID].initialPhysicalAddress;
+		descriptor.destination=DMABUFFERBASE;
+		descriptor.length=processTable[PID].processSize;
+		DMA_Start(&descriptor);
+		dmaSwapOutPID=PID;
+		OperatingSystem_ShowTime(SYSMEM);
+		ComputerSystem_DebugMessage(191,SYSMEM,descriptor.length,PID,programList[processTable[PID].programListIndex]->executableName);
+		return SWAPPINGOUT;
+	}
+
+	if (fseek(swap, (long) PID*MAINMEMORYSIZE*sizeof(MEMORYCELL), SEEK_SET)!=0)
+		return NO;
+	for (i=0; i<processTable[PID].processSize; i++) {
+		cell=Processor_CopyFromSystemStack(processTable[PID].initialPhysicalAddress+i);
+		if (fwrite(&cell, sizeof(MEMORYCELL), 1, swap)!=1) {
+			ComputerSystem_DebugMessage(183,ERROR,swapFile);
+			return NO;
+		}
+	}
+	fflush(swap);
+	OperatingSystem_EndSwapOut(PID);
+	return SUCCESS;
+}
+
+// The memory of a process is in the swap file: it is SWAPPED and its partition is free
+void OperatingSystem_EndSwapOut(int PID) {
+	int partitionIndex=processTable[PID].partitionIndex;
+
+	OperatingSystem_ShowPartitionTable("before swapping out");
+	partitionsTable[partitionIndex].PID=NOPROCESS;
+	OperatingSystem_AccountStateTime(PID);
+	processTable[PID].state=SWAPPED;
+	numberOfSwapOuts++;
+	OperatingSystem_ShowTime(SYSPROC);
+	ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex] -> executableName, statesNames[BLOCKED], statesNames[SWAPPED]);
+	OperatingSystem_ShowTime(SYSMEM);
+	ComputerSystem_DebugMessage(180,SYSMEM,PID,programList[processTable[PID].programListIndex]->executableName,
+		partitionIndex,partitionsTable[partitionIndex].initAddress,partitionsTable[partitionIndex].size);
+	OperatingSystem_ShowPartitionTable("after swapping out");
+}
+
+// Bring back the memory of a swapped out process that wakes up, to any
+// partition with room for it (swapping out other sleepers if needed).
+// Return SUCCESS, or MEMORYFULL if there is no room yet
+int OperatingSystem_SwapIn(int PID) {
+	int i, partitionIndex, dma;
+	MEMORYCELL cell;
+	DMA_DESCRIPTOR descriptor;
+	FILE *swap=OperatingSystem_SwapFile();
+
+	partitionIndex=OperatingSystem_ObtainMainMemory(processTable[PID].processSize, PID);
+	while (partitionIndex==MEMORYFULL && OperatingSystem_SwapOutSleeper(processTable[PID].processSize)==SUCCESS)
+		partitionIndex=OperatingSystem_ObtainMainMemory(processTable[PID].processSize, PID);
+	if (partitionIndex<0 || swap==NULL || fseek(swap, (long) PID*MAINMEMORYSIZE*sizeof(MEMORYCELL), SEEK_SET)!=0) {
+		OperatingSystem_ShowTime(SYSMEM);
+		ComputerSystem_DebugMessage(182,SYSMEM,PID,programList[processTable[PID].programListIndex]->executableName);
+		return MEMORYFULL;
+	}
+
+	OperatingSystem_ShowPartitionTable("before swapping in");
+	// The swap file is read in the buffer of the DMA controller, which copies
+	// it in the partition while other processes run. If it is busy, the
+	// processor copies it
+	dma=!DMA_IsBusy();
+	for (i=0; i<processTable[PID].processSize; i++) {
+		if (fread(&cell, sizeof(MEMORYCELL), 1, swap)!=1)
+			cell=0;
+		if (dma)
+			DMA_WriteBuffer(i, cell);
+		else
+			Processor_CopyInSystemStack(partitionsTable[partitionIndex].initAddress+i, cell);
+	}
+	if (dma) {
+		descriptor.source=DMABUFFERBASE;
+		descriptor.destination=partitionsTable[partitionIndex].initAddress;
+		descriptor.length=processTable[PID].processSize;
+		DMA_Start(&descriptor);
+		dmaSwapInPID=PID;
+	}
+
+	// The process may go on in other partition, as the MMU relocates its addresses
+	partitionsTable[partitionIndex].PID=PID;
+	processTable[PID].partitionIndex=partitionIndex;
+	processTable[PID].initialPhysicalAddress=partitionsTable[partitionIndex].initAddress;
+	// The profiler already has the image of the program, so no offset is needed
+	Profiler_ProgramLoaded(programList[processTable[PID].programListIndex]->executableName, 0, processTable[PID].initialPhysicalAddress);
+	numberOfSwapIns++;
+	OperatingSystem_ShowTime(SYSMEM);
+	ComputerSystem_DebugMessage(181,SYSMEM,PID,programList[processTable[PID].programListIndex]->executableName,
+		partitionIndex,partitionsTable[partitionIndex].initAddress,partitionsTable[partitionIndex].size);
+	if (dma) {
+		OperatingSystem_ShowTime(SYSMEM);
+		ComputerSystem_DebugMessage(191,SYSMEM,descriptor.length,PID,programList[processTable[PID].programListIndex]->executableName);
+	}
+	OperatingSystem_ShowPartitionTable("after swapping in");
+	return SUCCESS;
+}
+
+// Read (toSwapFile=0) or write (toSwapFile=1) the image of a swapped out
+// process in its slot of the swap file, for a checkpoint. Return SUCCESS, or
+// NO if the swap file fails
+int OperatingSystem_SwapImage(int PID, MEMORYCELL *image, int toSwapFile) {
+	FILE *swap=OperatingSystem_SwapFile();
+	size_t cells=processTable[PID].processSize;
+
+	if (swap==NULL || fseek(swap, (long) PID*MAINMEMORYSIZE*sizeof(MEMORYCELL), SEEK_SET)!=0)
+		return NO;
+	if ((toSwapFile ? fwrite(image, sizeof(MEMORYCELL), cells, swap) : fread(image, sizeof(MEMORYCELL), cells, swap))!=cells)
+		return NO;
+	if (toSwapFile)
+		fflush(swap);
+	return SUCCESS;
+}
+
+// Show the processes swapped out and in, if the medium-term scheduler has worked
+void OperatingSystem_PrintSwapReport() {
+	if (numberOfSwapOuts==0)
+		return;
+	OperatingSystem_ShowTime(SHUTDOWN);
+	ComputerSystem_DebugMessage(184,SHUTDOWN,numberOfSwapOuts,numberOfSwapIns,swapFile);
+}
+
+// Select the admission policy for the programs that find no free partition
+// Return SUCCESS, or INVALIDOPTION if there is no policy with that name
+int OperatingSystem_SelectAdmissionPolicy(char *name) {
+	int i;
+
+	for (i=0; name!=NULL && i<NUMBEROFADMISSIONPOLICIES; i++)
+		if (strcasecmp(admissionPolicyNames[i], name)==0) {
+			admissionPolicy=i;
+			return SUCCESS;
+		}
+	return INVALIDOPTION;
+}
+
+// Return YES if the program in that position of programList waits for admission
+int OperatingSystem_IsPendingAdmission(int programListIndex) {
+	int i;
+
+	for (i=0; i<numberOfPendingAdmissions; i++)
+		if (pendingAdmissionQueue[i].programListIndex==programListIndex)
+			return YES;
+	return NO;
+}
+
+// Keep a program that has found no free partition in the pending admission queue
+// Return SUCCESS, or NO if the program must be dropped
+int OperatingSystem_DeferAdmission(int programListIndex) {
+	FILE *programFile;
+	int i, processSize, manifestPrograms=0;
+
+	// Without an admission policy, only a program that waits for the partition
+	// the DMA controller is swapping out is kept
+	if (admissionPolicy==ADMISSION_DROP && dmaSwapOutPID==NOPROCESS)
+		return NO;
+
+	// The programs of the manifest must leave entries of programList for the
+	// processes created from it and for its next program
+	for (i=0; i<numberOfPendingAdmissions; i++)
+		if (pendingAdmissionQueue[i].programListIndex>=manifestBaseIndex)
+			manifestPrograms++;
+	if (programListIndex>=manifestBaseIndex
+		&& manifestPrograms>=PROGRAMSMAXNUMBER-manifestBaseIndex-PROCESSTABLEMAXSIZE)
+		return NO;
+
+	processSize=OperatingSystem_ObtainProgramSize(&programFile, programList[programListIndex]->executableName);
+	if (programFile!=NULL)
+		fclose(programFile);
+
+	pendingAdmissionQueue[numberOfPendingAdmissions].programListIndex=programListIndex;
+	pendingAdmissionQueue[numberOfPendingAdmissions].size=processSize;
+	numberOfPendingAdmissions++;
+	OperatingSystem_ShowTime(SYSMEM);
+	ComputerSystem_DebugMessage(185,SYSMEM,programList[programListIndex]->executableName,processSize,admissionPolicyNames[admissionPolicy]);
+	return SUCCESS;
+}
+
+// A partition has been released: admit the pending programs that fit now,
+// in the order given by the admission policy
+void OperatingSystem_RetryAdmissions() {
+	int i, selected, programListIndex, numberOfCreatedProcesses=0;
+
+	// No process is admitted while the system shuts down
+	if (processTable[sipID].state==EXIT)
+		return;
+
+	while ((selected=OperatingSystem_SelectPendingAdmission())!=NOPROCESS) {
+		programListIndex=pendingAdmissionQueue[selected].programListIndex;
+		numberOfPendingAdmissions--;
+		for (i=selected; i<numberOfPendingAdmissions; i++)
+			pendingAdmissionQueue[i]=pendingAdmissionQueue[i+1];
+		numberOfCreatedProcesses+=OperatingSystem_AdmitProgram(programListIndex);
+	}
+
+	if (numberOfCreatedProcesses > 0)
+		OperatingSystem_PrintStatus();
+}
+
+// Return the position in the pending admission queue of the program to admit,
+// or NOPROCESS if none of them fits in a free partition
+int OperatingSystem_SelectPendingAdmission() {
+	int i, waste, selected=NOPROCESS, leastWaste=MAINMEMORYSIZE;
+
+	if (numberOfPendingAdmissions==0)
+		return NOPROCESS;
+
+	switch (admissionPolicy) {
+		case ADMISSION_DROP:
+		case ADMISSION_FIFO:
+			// Programs are admitted in arrival order, the first one blocks the rest
+			selected=0;
+			break;
+		case ADMISSION_SMALLEST:
+			selected=0;
+			for (i=1; i<numberOfPendingAdmissions; i++)
+				if (pendingAdmissionQueue[i].size<pendingAdmissionQueue[selected].size)
+					selected=i;
+			break;
+		case ADMISSION_BESTFIT:
+			// The program that leaves the least free space in its partition
+			for (i=0; i<numberOfPendingAdmissions; i++) {
+				waste=OperatingSystem_FreePartitionWaste(pendingAdmissionQueue[i].size);
+				if (waste!=NOPROCESS && waste<leastWaste) {
+					leastWaste=waste;
+					selected=i;
+				}
+			}
+			return selected;
+	}
+	if (selected!=NOPROCESS && OperatingSystem_FreePartitionWaste(pendingAdmissionQueue[selected].size)==NOPROCESS)
+		return NOPROCESS;
+	return selected;
+}
+
+// Return the cells a process of that size leaves free in the free partition
+// that fits it best, or NOPROCESS if no free partition is big enough
+int OperatingSystem_FreePartitionWaste(int processSize) {
+	int i, waste=NOPROCESS;
+
+	for (i=0; i<PARTITIONTABLEMAXSIZE; i++)
+		if (partitionsTable[i].PID==NOPROCESS && partitionsTable[i].size>=processSize
+			&& (waste==NOPROCESS || partitionsTable[i].size-processSize<waste))
+			waste=partitionsTable[i].size-processSize;
+	return waste;
+}
+
+// Show the programs that were still waiting for a free partition at shutdown
+void OperatingSystem_PrintPendingAdmissions() {
+	int i;
+
+	for (i=0; i<numberOfPendingAdmissions; i++) {
+		OperatingSystem_ShowTime(SHUTDOWN);
+		ComputerSystem_DebugMessage(186,SHUTDOWN,programList[pendingAdmissionQueue[i].programListIndex]->executableName,
+			pendingAdmissionQueue[i].size);
+	}
+}
+
+// Send a request to a device through the buses: a value to write in the output
+// device, or a value to read from the input device
+// Return SUCCESS, or NO if the device can not queue the request
+int OperatingSystem_StartIO(int device, int value) {
+	BUSDATACELL data;
+
+	data.cell=value;
+	Processor_SetMBR(&data);
+	Buses_write_DataBus_From_To(CPU, device);
+	Processor_SetCTRL(device == INPUTDEVICE ? CTRLREAD : CTRLWRITE);
+	Buses_write_ControlBus_From_To(CPU, device);
+	// The result is in the status bits of the control register of the device
+	return (Device_GetCTRL(device) & CTRL_SUCCESS) ? SUCCESS : NO;
+}
+
+// Take from a device the oldest request it has served, and its value
+// Return SUCCESS, or NO if the device has no served request
+int OperatingSystem_AcknowledgeIO(int device, int *value) {
+	BUSDATACELL data;
+
+	Processor_SetCTRL(CTRLACK);
+	Buses_write_ControlBus_From_To(CPU, device);
+	if (!(Device_GetCTRL(device) & CTRL_SUCCESS))
+		return NO;
+	Buses_write_DataBus_From_To(device, CPU);
+	Processor_GetMBR(&data);
+	*value=data.cell;
+	return SUCCESS;
+}
+
+// Block a process in the wait queue of a device until its request is served
+void OperatingSystem_MoveToTheDeviceQueue(int PID, int device) {
+	int previousState = processTable[PID].state;
+
+	deviceWaitQueue[DEVICEINDEX(device)][numberOfProcessesWaitingDevice[DEVICEINDEX(device)]++]=PID;
+	OperatingSystem_AccountStateTime(PID);
+	processTable[PID].state = BLOCKED;
+	OperatingSystem_ShowTime(SYSPROC);
+	ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex] -> executableName, statesNames[previousState], statesNames[BLOCKED]);
+	OperatingSystem_ShowTime(SYSPROC);
+	ComputerSystem_DebugMessage(189, SYSPROC, PID, programList[processTable[PID].programListIndex] -> executableName, deviceNames[DEVICEINDEX(device)]);
+}
+
+// A device has served one or more requests: their processes are ready again
+void OperatingSystem_HandleIOEndInterrupt() {
+	int i, j, PID, value, numberOfProcessToWakeUp = 0;
+
+	OperatingSystem_ShowTime(INTERRUPT);
+	ComputerSystem_DebugMessage(188,INTERRUPT);
+
+	for (i = 0; i < NUMBEROFDEVICES; i++)
+		while (numberOfProcessesWaitingDevice[i] > 0 && OperatingSystem_AcknowledgeIO(INPUTDEVICE+i, &value) == SUCCESS) {
+			PID = deviceWaitQueue[i][0];
+			numberOfProcessesWaitingDevice[i]--;
+			for (j = 0; j < numberOfProcessesWaitingDevice[i]; j++)
+				deviceWaitQueue[i][j] = deviceWaitQueue[i][j+1];
+			// The value read is left in the accumulator of the process
+			if (i == DEVICEINDEX(INPUTDEVICE))
+				processTable[PID].copyOfAccumulatorRegister = value;
+			OperatingSystem_ShowTime(INTERRUPT);
+			ComputerSystem_DebugMessage(187,INTERRUPT,deviceNames[i],value);
+			OperatingSystem_ShowTime(SYSPROC);
+			ComputerSystem_DebugMessage(190,SYSPROC,PID,programList[processTable[PID].programListIndex]->executableName,deviceNames[i],value);
+			if (processTable[PID].queueID == USERPROCESSQUEUE)
+				schedulers[schedulingPolicy].wake(PID);
+			OperatingSystem_MoveToTheREADYState(PID);
+			numberOfProcessToWakeUp++;
+		}
+
+	if (numberOfProcessToWakeUp > 0) {
+		OperatingSystem_PrintStatus();
+		OperatingSystem_CheckIfIsNecessaryToChangeProcess();
+	}
+}
+
+// The DMA controller has ended a copy: the process swapped in with it is ready,
+// or the memory of the process swapped out with it goes to the swap file and
+// its partition is free for the programs waiting for one
+void OperatingSystem_HandleDMAEndInterrupt() {
+	int i, PID = dmaSwapInPID;
+	MEMORYCELL cell;
+	FILE *swap;
+
+	OperatingSystem_ShowTime(INTERRUPT);
+	ComputerSystem_DebugMessage(192,INTERRUPT);
+
+	if (dmaSwapOutPID != NOPROCESS) {
+		PID = dmaSwapOutPID;
+		dmaSwapOutPID = NOPROCESS;
+		swap = OperatingSystem_SwapFile();
+		if (swap == NULL || fseek(swap, (long) PID*MAINMEMORYSIZE*sizeof(MEMORYCELL), SEEK_SET) != 0)
+			return;
+		for (i = 0; i < processTable[PID].processSize; i++) {
+			cell = DMA_ReadBuffer(i);
+			if (fwrite(&cell, sizeof(MEMORYCELL), 1, swap) != 1) {
+				ComputerSystem_DebugMessage(183,ERROR,swapFile);
+				return;
+			}
+		}
+		fflush(swap);
+		OperatingSystem_EndSwapOut(PID);
+		OperatingSystem_RetryAdmissions();
+		OperatingSystem_CheckIfIsNecessaryToChangeProcess();
+		return;
+	}
+
+	if (PID == NOPROCESS)
+		return;
+	dmaSwapInPID = NOPROCESS;
+	OperatingSystem_PrepareWokenProcess(PID);
+	OperatingSystem_MoveToTheREADYState(PID);
+	OperatingSystem_PrintStatus();
+	OperatingSystem_CheckIfIsNecessaryToChangeProcess();
+}
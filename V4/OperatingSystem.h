@@ -3,6 +3,7 @@
 #define SLEEPINGQUEUE
 
 #include "ComputerSystem.h"
+#include "MainMemory.h"
 #include <stdio.h>
 
 
@@ -19,23 +20,67 @@
 
 #define MEMORYFULL -5
 
+#define INVALIDOPTION -6
+
+#define NOTSCHEDULABLE -7
+
+#define SWAPPINGOUT -8
+
 #define NOPROCESS -1
 
 // Partitions configuration file name definition
 #define MEMCONFIG "MemConfig" // in OperatingSystem.h 
 
-// Definition of daemons queue and user process queue
-#define NUMBEROFQUEUES 2
-enum TypeOfReadyToRunProcessQueues { USERPROCESSQUEUE, DAEMONSQUEUE}; 
+// Definition of daemons queue, user process queue and real-time process queue.
+// Real-time processes are scheduled before user processes, and these before daemons
+#define NUMBEROFQUEUES 3
+enum TypeOfReadyToRunProcessQueues { USERPROCESSQUEUE, DAEMONSQUEUE, REALTIMEQUEUE}; 
+
+// Short-term scheduling policies for the user processes
+enum SchedulingPolicies { SCHEDULER_PRIORITY, SCHEDULER_MLFQ, SCHEDULER_CFS, NUMBEROFSCHEDULERS };
+
+// Operations of a short-term scheduling policy. The ready-to-run operations
+// work on every queue; the others only on user processes
+typedef struct {
+	char *name; // Name in the --scheduler option
+	int (*enqueue)(int); // Insert a process in its ready-to-run queue (negative if full)
+	int (*dequeue)(int); // Extract the first process of a queue (NOPROCESS if empty)
+	int (*peek)(int); // First process of a queue, without extracting it
+	int (*tick)(int); // Charge a clock interrupt to the executing process (NOPROCESS if idle), YES if its quantum expired
+	int (*yield)(int); // YES if the executing process can yield the processor to the given ready one
+	void (*wake)(int); // Prepare a process that returns from SYSCALL_SLEEP
+	int (*key)(int); // Order in the ready-to-run queue: the lower, the sooner
+} SCHEDULING_POLICY;
+
+// Multi-level feedback queue limits and default configuration (--mlfq option)
+#define MLFQMAXLEVELS 8
+#define MLFQDEFAULTOPTION "1,2,4:20"
+
+// Completely-fair scheduler: default minimum granularity (--cfs option), in
+// clock interrupts a process keeps the processor before it can be preempted
+#define CFSDEFAULTGRANULARITY 2
+
+// Admission of the programs that find no free partition (--admission option):
+// they are dropped, or wait in the pending admission queue until a partition
+// is released, to be admitted in arrival order, smallest first or by best fit
+enum AdmissionPolicies { ADMISSION_DROP, ADMISSION_FIFO, ADMISSION_SMALLEST, ADMISSION_BESTFIT, NUMBEROFADMISSIONPOLICIES };
+
+// A program of the pending admission queue
+typedef struct {
+	int programListIndex;
+	int size;
+} PENDINGADMISSION;
 
 // Contains the possible type of programs
 enum ProgramTypes { USERPROGRAM, DAEMONPROGRAM }; 
 
 // Enumerated type containing all the possible process states
-enum ProcessStates { NEW, READY, EXECUTING, BLOCKED, EXIT};
+// (a SWAPPED process is a BLOCKED one whose memory is in the swap file)
+enum ProcessStates { NEW, READY, EXECUTING, BLOCKED, EXIT, SWAPPED};
 
 // Enumerated type containing the list of system calls and their numeric identifiers
-enum SystemCallIdentifiers { SYSCALL_END=3, SYSCALL_YIELD=4,SYSCALL_PRINTEXECPID=5, SYSCALL_SLEEP=7};
+// (SYSCALL_IOREAD leaves the value read in the accumulator; SYSCALL_IOWRITE writes it)
+enum SystemCallIdentifiers { SYSCALL_END=3, SYSCALL_YIELD=4,SYSCALL_PRINTEXECPID=5, SYSCALL_SLEEP=7, SYSCALL_IOREAD=8, SYSCALL_IOWRITE=9};
 
 // A PCB contains all of the information about a process that is needed by the OS
 typedef struct {
@@ -47,21 +92,82 @@ typedef struct {
 	int copyOfPCRegister;
 	unsigned int copyOfPSWRegister;
 	int copyOfAccumulatorRegister;
+	int copyOfRegisterA;
+	int copyOfRegisterB;
+	int copyOfSPRegister;
+	int stackLimit;
 	int programListIndex;
 	int queueID;
 	int whenToWakeUp;
 	int partitionIndex;
+	// Clock interrupts used of the current quantum (round-robin or multi-level
+	// feedback queue) and level in the multi-level feedback queue
+	int quantumUsed;
+	int level;
+	// Completely-fair scheduler: processor time weighted by the priority
+	int vruntime;
+	// Real-time processes (clock interrupts): relative deadline, period and
+	// execution time declared by the program, and absolute deadline and next
+	// release of the current job
+	int relativeDeadline;
+	int period;
+	int executionTime;
+	int absoluteDeadline;
+	int nextRelease;
+	int deadlineMissed;
+	// Accounting (times in tics)
+	int creationTime;
+	int firstDispatchTime; // -1 until the process uses the processor
+	int lastStateChangeTime;
+	int cpuTics;
+	int readyTics;
+	int sleepingTics;
+	int numberOfContextSwitches;
+	int terminationTime; // -1 while the process has not finished
 } PCB;
 
+// Totals of the processes accounted in the scheduling metrics report
+typedef struct {
+	int numberOfProcesses;
+	int sumTurnaround;
+	int sumResponse;
+	int sumWaiting;
+	int sumCpuTics;
+	int idleTics; // Tics used by the System Idle Process
+	int numberOfContextSwitches;
+} ACCOUNTING_DATA;
+
 // These "extern" declaration enables other source code files to gain access
 // to the variable listed
 extern PCB processTable[];
 extern int OS_address_base;
 extern int sipID;
+extern int fastForward;
+extern int numberOfSkippedIdleTics;
+extern char *accountingFile;
+extern int schedulingPolicy;
+extern SCHEDULING_POLICY schedulers[];
+extern int roundRobinQuantum;
+extern int cfsGranularity;
+extern char *swapFile;
+extern int admissionPolicy;
+extern ACCOUNTING_DATA accountingTotals;
 
 // Functions prototypes
 void OperatingSystem_Initialize();
 void OperatingSystem_InterruptLogic(int);
 int OperatingSystem_GetExecutingProcessID();
+void OperatingSystem_FastForwardIdle();
+void OperatingSystem_PrintFinalState();
+void OperatingSystem_PrintAccountingReport();
+void OperatingSystem_PrintRealTimeReport();
+void OperatingSystem_PrintSwapReport();
+int OperatingSystem_SwapImage(int, MEMORYCELL *, int);
+int OperatingSystem_SchedulingKey(int);
+int OperatingSystem_ParseMLFQOption(char *);
+int OperatingSystem_SelectScheduler(char *);
+int OperatingSystem_SelectAdmissionPolicy(char *);
+int OperatingSystem_IsPendingAdmission(int);
+void OperatingSystem_PrintPendingAdmissions();
 
 #endif
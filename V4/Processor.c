@@ -3,8 +3,16 @@
 #include "OperatingSystem.h"
 #include "Buses.h"
 #include "Clock.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
+#include "MMU.h"
+#include "Cache.h"
+#include "Hooks.h"
+#include "ComputerSystemBase.h"
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <stdlib.h>
 
 // Internals Functions prototypes
 
@@ -13,6 +21,14 @@ void Processor_DecodeAndExecuteInstruction();
 void Processor_ManageInterrupts();
 void Processor_ShowTime(char);
 int Processor_GetRegisterB();
+int Processor_SelectInterrupt(unsigned int);
+void Processor_DeliverInterruptBatch();
+void Processor_ChargeBlockTics(int);
+int *Processor_IndexRegister(int);
+int Processor_EffectiveAddress(int, int, int *);
+int Processor_Push(int);
+int Processor_Pop(int *);
+void Processor_CacheDataAccess();
 
 // External data
 extern char *InstructionNames[];
@@ -28,9 +44,22 @@ int registerCTRL_CPU; // Control bus Register
 
 int registerA_CPU; // General purpose register
 int registerB_CPU; // Another general purpose register Exercise 1-a of V4
+int registerSP_CPU; // User stack pointer: logical address of the top of the stack
+int registerSPLimit_CPU; // Lowest address the user stack can grow to
 
 int interruptLines_CPU; // Processor interrupt lines
 
+// Programmable interrupt controller: priority of every line (the lower the
+// value, the higher the priority; by default the line number) and lines
+// acknowledged in the last interrupt entry that are still to be delivered to
+// the OS (batch mode)
+int interruptPriority_PIC[INTERRUPTTYPES]={0,1,2,3,4,5,6,7,8,9};
+unsigned int interruptBatch_PIC=0;
+int interruptBatchMode=0; // Set by --interruptBatch
+
+// Cells moved by a block instruction every tic
+int blockCellsPerTic=BLOCKDEFAULTCELLSPERTIC;
+
 // interrupt vector table: an array of handle interrupt memory addresses routines  
 int interruptVectorTable[INTERRUPTTYPES];
 
@@ -46,27 +75,40 @@ void Processor_InitializeInterruptVectorTable(int interruptVectorInitialAddress)
 	interruptVectorTable[SYSCALL_BIT]=interruptVectorInitialAddress;  // SYSCALL_BIT=2
 	interruptVectorTable[EXCEPTION_BIT]=interruptVectorInitialAddress+2; // EXCEPTION_BIT=6
 	interruptVectorTable[CLOCKINT_BIT]=interruptVectorInitialAddress+4; // CLOCKINT_BIT=9
+	interruptVectorTable[IOEND_BIT]=interruptVectorInitialAddress+6; // IOEND_BIT=8
+	interruptVectorTable[DMAEND_BIT]=interruptVectorInitialAddress+8; // DMAEND_BIT=7
 }
 
 
 // This is the instruction cycle loop (fetch, decoding, execution, etc.).
 // The processor stops working when an POWEROFF signal is stored in its
-// PSW register
+// PSW register or when the time given by --endSimulationTime is reached
 void Processor_InstructionCycleLoop() {
 
-	while (!Processor_PSW_BitState(POWEROFF_BIT)) {
+	while (!Processor_PSW_BitState(POWEROFF_BIT)
+		&& (endSimulationTime<0 || Clock_GetTime()<endSimulationTime)) {
+		// The state between two instructions is the one saved in a checkpoint
+		if (checkpointTime>=0 && Clock_GetTime()>=checkpointTime)
+			ComputerSystem_TakeCheckpoint();
 		if (Processor_FetchInstruction()==CPU_SUCCESS){
 			Processor_DecodeAndExecuteInstruction();
+			HOOK_AFTER_DECODEANDEXECUTEINSTRUCTION();
 		}
 		if (interruptLines_CPU && !Processor_PSW_BitState(INTERRUPT_MASKED_BIT)){
 			Processor_ManageInterrupts();
 		}
+		else if (fastForward && !interruptLines_CPU && !Processor_PSW_BitState(INTERRUPT_MASKED_BIT)) {
+			OperatingSystem_FastForwardIdle();
+		}
 	}
+	HOOK_AFTER_INSTRUCTIONCYCLELOOP();
 }
 
 // Fetch an instruction from main memory and put it in the IR register
 int Processor_FetchInstruction() {
 
+	HOOK_BEFORE_FETCHINSTRUCTION();
+
 	// The instruction must be located at the logical memory address pointed by the PC register
 	registerMAR_CPU=registerPC_CPU;
 	// Send to the MMU the address in which the reading has to take place: use the address bus for this
@@ -79,9 +121,11 @@ int Processor_FetchInstruction() {
 		// All the read data is stored in the MBR register. Because it is an instruction
 		// we have to copy it to the IR register
 		memcpy((void *) (&registerIR_CPU), (void *) (&registerMBR_CPU), sizeof(BUSDATACELL));
+		// The MMU holds the physical address the instruction was fetched from
+		Cache_Access(INSTRUCTIONCACHE, MMU_GetMAR());
 		// Show initial part of HARDWARE message with Operation Code and operands
 		// Show message: operationCode operand1 operand2
-		char codedInstruction[13]; // Coded instruction with separated fields to show
+		char codedInstruction[23]; // Coded instruction with separated fields to show
 		Processor_GetCodedInstruction(codedInstruction,registerIR_CPU);
 		Processor_ShowTime(HARDWARE);
 		ComputerSystem_DebugMessage(68, HARDWARE, codedInstruction);
@@ -98,12 +142,18 @@ int Processor_FetchInstruction() {
 // Decode and execute the instruction in the IR register
 void Processor_DecodeAndExecuteInstruction() {
 	int tempAcc; // for save accumulator if necesary
+	int destination, source; // physical addresses of block instructions
+	int *index; // index register of the READ, WRITE and XCHG instructions
 
 	// Decode
 	int operationCode=Processor_DecodeOperationCode(registerIR_CPU);
 	int operand1=Processor_DecodeOperand1(registerIR_CPU);
 	int operand2=Processor_DecodeOperand2(registerIR_CPU);
 
+	// The MMU still holds the physical address the instruction was fetched from
+	if (profile)
+		Profiler_CountInstruction(MMU_GetMAR(),operationCode,Processor_PSW_BitState(EXECUTION_MODE_BIT));
+
 	Processor_DeactivatePSW_Bit(OVERFLOW_BIT);
 
 	// Execute
@@ -167,7 +217,8 @@ void Processor_DecodeAndExecuteInstruction() {
 		// Instruction WRITE
 		case WRITE_INST: 
 			registerMBR_CPU.cell=registerAccumulator_CPU;
-			registerMAR_CPU=operand1;
+			if (Processor_EffectiveAddress(operand1,operand2,&registerMAR_CPU)==CPU_FAIL)
+				break;
 			// Send to the main memory controller the data to be written: use the data bus for this
 			Buses_write_DataBus_From_To(CPU, MAINMEMORY);
 			// Send to the MMU controller the address in which the writing has to take place: use the address bus for this
@@ -175,17 +226,20 @@ void Processor_DecodeAndExecuteInstruction() {
 			// Tell the MMU controller to write
 			registerCTRL_CPU=CTRLWRITE;
 			Buses_write_ControlBus_From_To(CPU,MMU);
+			Processor_CacheDataAccess();
 			registerPC_CPU++;
 			break;
 
 		// Instruction READ
 		case READ_INST: 
-			registerMAR_CPU=operand1;
+			if (Processor_EffectiveAddress(operand1,operand2,&registerMAR_CPU)==CPU_FAIL)
+				break;
 			// Send to the MMU controller the address in which the reading has to take place: use the address bus for this
 			Buses_write_AddressBus_From_To(CPU, MMU);
 			// Tell the MMU controller to read
 			registerCTRL_CPU=CTRLREAD;
 			Buses_write_ControlBus_From_To(CPU,MMU);
+			Processor_CacheDataAccess();
 
 			// Copy the read data to the accumulator register
 			registerAccumulator_CPU= registerMBR_CPU.cell;
@@ -218,6 +272,9 @@ void Processor_DecodeAndExecuteInstruction() {
 			} else {
 				// Not all operating system code is executed in simulated processor, but really must do it... 
 				OperatingSystem_InterruptLogic(operand1);
+				// Interrupts acknowledged in the same entry are handled now
+				if (interruptBatch_PIC)
+					Processor_DeliverInterruptBatch();
 				registerPC_CPU++;
 				// Update PSW bits (ZERO_BIT, NEGATIVE_BIT, ...)
 				Processor_UpdatePSW();
@@ -233,6 +290,9 @@ void Processor_DecodeAndExecuteInstruction() {
 				registerPC_CPU=Processor_CopyFromSystemStack(MAINMEMORYSIZE-1);
 				registerPSW_CPU=Processor_CopyFromSystemStack(MAINMEMORYSIZE-2);
 				registerAccumulator_CPU = Processor_CopyFromSystemStack(MAINMEMORYSIZE - 3);
+				// Batched interrupts not delivered by an OS instruction are raised again
+				interruptLines_CPU |= interruptBatch_PIC;
+				interruptBatch_PIC=0;
 			}
 				
 			break;		
@@ -245,12 +305,104 @@ void Processor_DecodeAndExecuteInstruction() {
 			// Tell the main memory controller to read
 			registerCTRL_CPU=CTRLREAD;
 			Buses_write_ControlBus_From_To(CPU,MMU);
+			Processor_CacheDataAccess();
 			// Copy the read data to the accumulator register
 			registerAccumulator_CPU= operand1 + registerMBR_CPU.cell;
 			Processor_CheckOverflow(operand1,registerMBR_CPU.cell);
 			registerPC_CPU++;
 			break;
 
+		// Instruction MEMCPY: copy accumulator cells from operand2 to operand1
+		case MEMCPY_INST:
+			destination=MMU_TranslateBlock(operand1, registerAccumulator_CPU);
+			if (destination<0)
+				break;
+			source=MMU_TranslateBlock(operand2, registerAccumulator_CPU);
+			if (source<0)
+				break;
+			MainMemory_Copy(destination, source, registerAccumulator_CPU);
+			Cache_AccessBlock(DATACACHE, source, registerAccumulator_CPU);
+			Cache_AccessBlock(DATACACHE, destination, registerAccumulator_CPU);
+			Processor_ChargeBlockTics(registerAccumulator_CPU);
+			registerPC_CPU++;
+			break;
+
+		// Instruction MEMSET: fill accumulator cells from operand1 with operand2
+		case MEMSET_INST:
+			destination=MMU_TranslateBlock(operand1, registerAccumulator_CPU);
+			if (destination<0)
+				break;
+			MainMemory_Fill(destination, operand2, registerAccumulator_CPU);
+			Cache_AccessBlock(DATACACHE, destination, registerAccumulator_CPU);
+			Processor_ChargeBlockTics(registerAccumulator_CPU);
+			registerPC_CPU++;
+			break;
+
+		// Instruction VADD: add accumulator cells from operand2 to the ones from operand1
+		case VADD_INST:
+			destination=MMU_TranslateBlock(operand1, registerAccumulator_CPU);
+			if (destination<0)
+				break;
+			source=MMU_TranslateBlock(operand2, registerAccumulator_CPU);
+			if (source<0)
+				break;
+			if (MainMemory_VectorAdd(destination, source, registerAccumulator_CPU))
+				Processor_ActivatePSW_Bit(OVERFLOW_BIT);
+			Cache_AccessBlock(DATACACHE, source, registerAccumulator_CPU);
+			Cache_AccessBlock(DATACACHE, destination, registerAccumulator_CPU);
+			Processor_ChargeBlockTics(registerAccumulator_CPU);
+			registerPC_CPU++;
+			break;
+
+		// Instruction VSUM: add up accumulator cells from operand1 into the accumulator
+		case VSUM_INST:
+			source=MMU_TranslateBlock(operand1, registerAccumulator_CPU);
+			if (source<0)
+				break;
+			tempAcc=registerAccumulator_CPU;
+			if (MainMemory_VectorSum(source, tempAcc, &registerAccumulator_CPU))
+				Processor_ActivatePSW_Bit(OVERFLOW_BIT);
+			Cache_AccessBlock(DATACACHE, source, tempAcc);
+			Processor_ChargeBlockTics(tempAcc);
+			registerPC_CPU++;
+			break;
+
+		// Instruction XCHG: exchange the accumulator with registerA or registerB
+		case XCHG_INST:
+			index=Processor_IndexRegister(operand1);
+			if (index==NULL || index==&registerAccumulator_CPU) {
+				Processor_RaiseException(INVALIDINSTRUCTION);
+				break;
+			}
+			tempAcc=registerAccumulator_CPU;
+			registerAccumulator_CPU=*index;
+			*index=tempAcc;
+			registerPC_CPU++;
+			break;
+
+		// Instruction CALL: push the return address and jump as JUMP
+		case CALL_INST:
+			if (Processor_Push(registerPC_CPU+1)==CPU_SUCCESS)
+				registerPC_CPU+= operand1;
+			break;
+
+		// Instruction RET: jump to the return address pushed by CALL
+		case RET_INST:
+			Processor_Pop(&registerPC_CPU);
+			break;
+
+		// Instruction PUSH: push the accumulator in the user stack
+		case PUSH_INST:
+			if (Processor_Push(registerAccumulator_CPU)==CPU_SUCCESS)
+				registerPC_CPU++;
+			break;
+
+		// Instruction POP: pop the top of the user stack into the accumulator
+		case POP_INST:
+			if (Processor_Pop(&registerAccumulator_CPU)==CPU_SUCCESS)
+				registerPC_CPU++;
+			break;
+
 		// Unknown instruction
 		default : 
 			Processor_RaiseException(INVALIDINSTRUCTION);
@@ -270,24 +422,30 @@ void Processor_DecodeAndExecuteInstruction() {
 void Processor_ManageInterrupts() {
   
 	int i;
-
-		for (i=0;i<INTERRUPTTYPES;i++)
-			// If an 'i'-type interrupt is pending
-			if (Processor_GetInterruptLineStatus(i)) {
-				// Deactivate interrupt
-				Processor_ACKInterrupt(i);
-				// Copy PC and PSW registers in the system stack
-				Processor_CopyInSystemStack(MAINMEMORYSIZE-1, registerPC_CPU);
-				Processor_CopyInSystemStack(MAINMEMORYSIZE-2, registerPSW_CPU);	
-				Processor_CopyInSystemStack(MAINMEMORYSIZE-3, registerAccumulator_CPU);	
-				// Activate interrupt masked bit
-				Processor_ActivatePSW_Bit(INTERRUPT_MASKED_BIT);
-				// Activate protected excution mode
-				Processor_ActivatePSW_Bit(EXECUTION_MODE_BIT);
-				// Call the appropriate OS interrupt-handling routine setting PC register
-				registerPC_CPU=interruptVectorTable[i];
-				break; // Don't process another interrupt
-			}
+	unsigned int pendingLines=interruptLines_CPU;
+
+		// The pending line with the highest priority is serviced
+		i=Processor_SelectInterrupt(pendingLines);
+		if (i<0)
+			return;
+		// Deactivate interrupt
+		Processor_ACKInterrupt(i);
+		// In batch mode, the rest of pending lines are delivered in the same OS entry.
+		// A synchronous line is never delivered after a handler that can dispatch
+		if (interruptBatchMode) {
+			interruptBatch_PIC=pendingLines & ~(1u<<i) & ~SYNCHRONOUSINTERRUPTS;
+			interruptLines_CPU &= ~interruptBatch_PIC;
+		}
+		// Copy PC and PSW registers in the system stack
+		Processor_CopyInSystemStack(MAINMEMORYSIZE-1, registerPC_CPU);
+		Processor_CopyInSystemStack(MAINMEMORYSIZE-2, registerPSW_CPU);	
+		Processor_CopyInSystemStack(MAINMEMORYSIZE-3, registerAccumulator_CPU);	
+		// Activate interrupt masked bit
+		Processor_ActivatePSW_Bit(INTERRUPT_MASKED_BIT);
+		// Activate protected excution mode
+		Processor_ActivatePSW_Bit(EXECUTION_MODE_BIT);
+		// Call the appropriate OS interrupt-handling routine setting PC register
+		registerPC_CPU=interruptVectorTable[i];
 }
 
 char * Processor_ShowPSW(){
@@ -318,4 +476,193 @@ void Processor_ShowTime(char section) {
 
 int Processor_GetRegisterB() {
   return registerB_CPU;
-}
\ No newline at end of file
+}
+
+int Processor_GetPC() {
+  return registerPC_CPU;
+}
+
+// Return the line with the highest priority among the given ones, or -1 if none.
+// Only the lines that are high are visited
+int Processor_SelectInterrupt(unsigned int lines) {
+	int line, selected=-1;
+
+	while (lines) {
+		line=ffs(lines)-1;
+		lines&=lines-1;
+		if (selected<0 || interruptPriority_PIC[line]<interruptPriority_PIC[selected])
+			selected=line;
+	}
+	return selected;
+}
+
+// Call the OS for every interrupt acknowledged with the one being handled,
+// in priority order, without saving the context again
+void Processor_DeliverInterruptBatch() {
+	int i;
+
+	while ((i=Processor_SelectInterrupt(interruptBatch_PIC))>=0) {
+		interruptBatch_PIC &= ~(1u<<i);
+		OperatingSystem_InterruptLogic(i);
+	}
+}
+
+// Set the priorities of the interrupt lines from a list of lines separated by
+// commas, the first one with the highest priority. The lines not in the list keep
+// their relative order after the listed ones. Return CPU_FAIL if the list is not valid
+// or if it puts any other line ahead of SYSCALL or EXCEPTION
+int Processor_SetInterruptPriorities(char *lines) {
+	int i, line, numberOfLines=0, lowestSynchronous=-1;
+	int priority[INTERRUPTTYPES];
+	char *token;
+
+	if (lines==NULL)
+		return CPU_FAIL;
+	for (i=0; i<INTERRUPTTYPES; i++)
+		priority[i]=-1;
+	for (token=strtok(lines,","); token!=NULL; token=strtok(NULL,",")) {
+		if (sscanf(token,"%d",&line)!=1 || line<0 || line>=INTERRUPTTYPES || priority[line]>=0)
+			return CPU_FAIL;
+		priority[line]=numberOfLines++;
+	}
+	for (i=0; i<INTERRUPTTYPES; i++) {
+		if (priority[i]<0)
+			priority[i]=numberOfLines+i;
+		if ((SYNCHRONOUSINTERRUPTS & (1u<<i)) && priority[i]>lowestSynchronous)
+			lowestSynchronous=priority[i];
+	}
+	for (i=0; i<INTERRUPTTYPES; i++)
+		if (!(SYNCHRONOUSINTERRUPTS & (1u<<i)) && priority[i]<lowestSynchronous)
+			return CPU_FAIL;
+	for (i=0; i<INTERRUPTTYPES; i++)
+		interruptPriority_PIC[i]=priority[i];
+	return CPU_SUCCESS;
+}
+
+// Copy the whole context of the interrupted program in a single operation: the
+// system stack words are read in one block transfer, not a bus transfer for each one
+void Processor_SaveRegisterFile(REGISTERFILE *registers) {
+	MEMORYCELL systemStack[SYSTEMSTACKCONTEXTSIZE];
+
+	MainMemory_ReadBlock(MAINMEMORYSIZE-SYSTEMSTACKCONTEXTSIZE, systemStack, SYSTEMSTACKCONTEXTSIZE);
+	registers->accumulator=systemStack[0];
+	registers->PSW=systemStack[1];
+	registers->PC=systemStack[2];
+	registers->registerA=registerA_CPU;
+	registers->registerB=registerB_CPU;
+	registers->stackPointer=registerSP_CPU;
+	registers->stackLimit=registerSPLimit_CPU;
+}
+
+// Load a whole context in a single operation. PC and PSW are taken from the
+// system stack by the IRET instruction
+void Processor_RestoreRegisterFile(REGISTERFILE *registers) {
+	MEMORYCELL systemStack[SYSTEMSTACKCONTEXTSIZE];
+
+	systemStack[0]=registers->accumulator;
+	systemStack[1]=registers->PSW;
+	systemStack[2]=registers->PC;
+	MainMemory_WriteBlock(MAINMEMORYSIZE-SYSTEMSTACKCONTEXTSIZE, systemStack, SYSTEMSTACKCONTEXTSIZE);
+	registerAccumulator_CPU=registers->accumulator;
+	registerA_CPU=registers->registerA;
+	registerB_CPU=registers->registerB;
+	registerSP_CPU=registers->stackPointer;
+	registerSPLimit_CPU=registers->stackLimit;
+}
+
+// A block instruction takes a tic (the one of the instruction) for every
+// blockCellsPerTic cells it moves
+void Processor_ChargeBlockTics(int length) {
+	int tics;
+
+	for (tics=(length+blockCellsPerTic-1)/blockCellsPerTic; tics>1; tics--)
+		Clock_Update();
+}
+
+// Set the cells moved by a block instruction every tic
+// Return CPU_FAIL if the value is not valid
+int Processor_SetBlockCost(char *cellsPerTic) {
+	int cells;
+
+	if (cellsPerTic==NULL || sscanf(cellsPerTic,"%d",&cells)!=1 || cells<=0)
+		return CPU_FAIL;
+	blockCellsPerTic=cells;
+	return CPU_SUCCESS;
+}
+
+// Register selected by the second operand of READ and WRITE, or the first of
+// XCHG. Return NULL if the operand does not name a register
+int *Processor_IndexRegister(int indexRegister) {
+	switch (indexRegister) {
+		case ACCUMULATOR_INDEX:
+			return &registerAccumulator_CPU;
+		case REGISTERA_INDEX:
+			return &registerA_CPU;
+		case REGISTERB_INDEX:
+			return &registerB_CPU;
+		default:
+			return NULL;
+	}
+}
+
+// Logical address accessed by READ and WRITE: the first operand, plus the
+// value of the index register given in the second one. The result is checked
+// by the MMU as any other address. Return CPU_FAIL (and raise an invalid
+// instruction exception) if the addressing mode does not exist
+int Processor_EffectiveAddress(int operand1, int operand2, int *address) {
+	int *index;
+
+	if (operand2==NOINDEX) {
+		*address=operand1;
+		return CPU_SUCCESS;
+	}
+	index=Processor_IndexRegister(operand2);
+	if (index==NULL) {
+		Processor_RaiseException(INVALIDINSTRUCTION);
+		return CPU_FAIL;
+	}
+	*address=operand1+*index;
+	return CPU_SUCCESS;
+}
+
+// The user stack grows down from the top of the memory of the process to its
+// limit. A stack overflow, as any address rejected by the MMU (popping an empty
+// stack), is an INVALIDADDRESS exception
+// Return CPU_FAIL if the address is not valid, without changing the stack pointer
+int Processor_Push(int value) {
+	if (registerSP_CPU<=registerSPLimit_CPU) {
+		Processor_RaiseException(INVALIDADDRESS);
+		return CPU_FAIL;
+	}
+	registerMBR_CPU.cell=value;
+	registerMAR_CPU=registerSP_CPU-1;
+	Buses_write_DataBus_From_To(CPU, MAINMEMORY);
+	Buses_write_AddressBus_From_To(CPU, MMU);
+	registerCTRL_CPU=CTRLWRITE;
+	Buses_write_ControlBus_From_To(CPU,MMU);
+	if (registerCTRL_CPU & CTRL_FAIL)
+		return CPU_FAIL;
+	Processor_CacheDataAccess();
+	registerSP_CPU--;
+	return CPU_SUCCESS;
+}
+
+int Processor_Pop(int *value) {
+	registerMAR_CPU=registerSP_CPU;
+	Buses_write_AddressBus_From_To(CPU, MMU);
+	registerCTRL_CPU=CTRLREAD;
+	Buses_write_ControlBus_From_To(CPU,MMU);
+	if (registerCTRL_CPU & CTRL_FAIL)
+		return CPU_FAIL;
+	Processor_CacheDataAccess();
+	*value=registerMBR_CPU.cell;
+	registerSP_CPU++;
+	return CPU_SUCCESS;
+}
+
+// A data access the MMU has accepted goes through the data cache. The MMU
+// holds its physical address
+void Processor_CacheDataAccess() {
+	if (registerCTRL_CPU & CTRL_SUCCESS)
+		Cache_Access(DATACACHE, MMU_GetMAR());
+}
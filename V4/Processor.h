@@ -16,11 +16,36 @@ enum PSW_BITS {POWEROFF_BIT=0, ZERO_BIT=1, NEGATIVE_BIT=2, OVERFLOW_BIT=3, EXECU
 
 // Enumerated type that connects bit positions in the interruptLines with
 // interrupt types 
-enum INT_BITS {SYSCALL_BIT=2, EXCEPTION_BIT=6, CLOCKINT_BIT=9};
+enum INT_BITS {SYSCALL_BIT=2, EXCEPTION_BIT=6, DMAEND_BIT=7, IOEND_BIT=8, CLOCKINT_BIT=9};
+
+// Lines raised by the executing instruction itself. They must be serviced before
+// the rest, whose handlers can change the executing process
+#define SYNCHRONOUSINTERRUPTS ((1u<<SYSCALL_BIT) | (1u<<EXCEPTION_BIT))
 
 // Enumerated type with differents exception types
 enum EXCEPTIONS {DIVISIONBYZERO, INVALIDPROCESSORMODE, INVALIDADDRESS, INVALIDINSTRUCTION};
 
+// Addressing modes of READ and WRITE, given in their second operand: absolute
+// (NOINDEX) or the first operand plus the value of an index register. XCHG
+// uses the same numbers for the general purpose registers
+enum INDEX_REGISTERS {NOINDEX, ACCUMULATOR_INDEX, REGISTERA_INDEX, REGISTERB_INDEX};
+
+// Words of the interrupted program in the top of the system stack: accumulator,
+// PSW and PC (at MAINMEMORYSIZE-1)
+#define SYSTEMSTACKCONTEXTSIZE 3
+
+// Registers that make up the context of a process: the ones of the interrupted
+// program saved in the system stack and the general purpose registers
+typedef struct {
+	int PC;
+	unsigned int PSW;
+	int accumulator;
+	int registerA;
+	int registerB;
+	int stackPointer;
+	int stackLimit;
+} REGISTERFILE;
+
 // Functions prototypes
 void Processor_InitializeInterruptVectorTable();
 void Processor_InstructionCycleLoop();
@@ -31,5 +56,18 @@ int Processor_GetCTRL();
 void Processor_SetCTRL(int);
 
 int Processor_GetRegisterB();
+int Processor_GetPC();
+
+// Hardware-assisted context switch
+void Processor_SaveRegisterFile(REGISTERFILE *);
+void Processor_RestoreRegisterFile(REGISTERFILE *);
+
+// Block instructions (MEMCPY, MEMSET): cells moved every tic (--blockCost option)
+#define BLOCKDEFAULTCELLSPERTIC 8
+int Processor_SetBlockCost(char *);
+
+// Programmable interrupt controller
+int Processor_SetInterruptPriorities(char *);
+extern int interruptBatchMode;
 
 #endif
@@ -194,15 +194,19 @@ unsigned int Processor_GetPSW(){
 	return registerPSW_CPU;
 }
 
-int Processor_Encode(int opCode, int op1, int op2) {
-	int mask=0x7ff; // binary: 0111 1111 1111 
+MEMORYCELL Processor_Encode(int opCode, int op1, int op2) {
+	int mask=OPERANDMASK; // binary: 0111 1111 1111 with 32 bits cells
 	int sigOp1=op1<0;
 	op1=sigOp1 ? ((-op1) & mask) : (op1 & mask);
 	int sigOp2=op2<0;
 	op2=sigOp2 ? ((-op2) & mask) : (op2 & mask);
-	int cell=(opCode<<24);
-	cell = cell | (sigOp1<<23) | (op1<<12);
-	cell = cell | (sigOp2<<11) | op2;
+	MEMORYCELL cell=(opCode<<24);
+	cell = cell | (sigOp1<<23) | ((op1 & 0x7ff)<<12);
+	cell = cell | (sigOp2<<11) | (op2 & 0x7ff);
+#ifdef WIDECELLS
+	// An instruction with small operands is coded as in 32 bits cells
+	cell = cell | (MEMORYCELL) ((unsigned long long) (op1>>11)<<48 | (unsigned long long) (op2>>11)<<32);
+#endif
 	return cell;
 }
 
@@ -214,6 +218,9 @@ int Processor_DecodeOperationCode(BUSDATACELL memCell) {
 int Processor_DecodeOperand1(BUSDATACELL memCell) {
 	int sigOp1=memCell.cell & (0x1<<23);
 	int op1=(memCell.cell & (0x7ff<<12))>>12;
+#ifdef WIDECELLS
+	op1|=((memCell.cell>>48) & 0xffff)<<11;
+#endif
 	op1=sigOp1?-op1:op1;
 	return op1;
 }
@@ -221,12 +228,20 @@ int Processor_DecodeOperand1(BUSDATACELL memCell) {
 int Processor_DecodeOperand2(BUSDATACELL memCell) {
 	int sigOp2= memCell.cell & (0x1<<11);
 	int op2=(memCell.cell & (0x7ff));
+#ifdef WIDECELLS
+	op2|=((memCell.cell>>32) & 0xffff)<<11;
+#endif
 	op2=sigOp2?-op2:op2;
 	return op2;
 }
 
 void Processor_GetCodedInstruction(char * result, BUSDATACELL memCell){
-	sprintf(result,"%02X %03X %03X",((registerIR_CPU.cell>>24)&0xff),((registerIR_CPU.cell>>12)&0xfff),(registerIR_CPU.cell&0xfff));	
+	sprintf(result,"%02X %03X %03X",(int) ((registerIR_CPU.cell>>24)&0xff),(int) ((registerIR_CPU.cell>>12)&0xfff),(int) (registerIR_CPU.cell&0xfff));	
+#ifdef WIDECELLS
+	// High bits of the operands, if any
+	if (registerIR_CPU.cell>>32)
+		sprintf(result+strlen(result)," %04X %04X",(int) ((registerIR_CPU.cell>>48)&0xffff),(int) ((registerIR_CPU.cell>>32)&0xffff));
+#endif
 }
 
 int Processor_ToInstruction(char * operation) {
@@ -11,6 +11,16 @@ NONEXISTING_INST,
 LAST_INST,
 };
 
+// An instruction is coded in the low 32 bits of a memory cell as an operation
+// code of 8 bits and two operands, each one a sign bit and 11 bits of absolute
+// value. With -DWIDECELLS, the high 32 bits hold 16 more bits of every operand
+#ifdef WIDECELLS
+#define OPERANDBITS 27
+#else
+#define OPERANDBITS 11
+#endif
+#define OPERANDMASK ((1<<OPERANDBITS)-1)
+
 void Processor_UpdatePSW();
 void Processor_CheckOverflow(int , int );
 
@@ -52,7 +62,7 @@ int Processor_GetRegisterA();
 void Processor_SetPSW(unsigned int);
 unsigned int Processor_GetPSW();
 
-int Processor_Encode(int , int , int);
+MEMORYCELL Processor_Encode(int , int , int);
 int Processor_DecodeOperationCode(BUSDATACELL);
 int Processor_DecodeOperand1(BUSDATACELL);
 int Processor_DecodeOperand2(BUSDATACELL);
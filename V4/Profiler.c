@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Profiler.h"
+#include "ComputerSystem.h"
+
+// Functions prototypes
+int Profiler_ObtainImage(char *, long);
+void Profiler_FoldAddress(int);
+int Profiler_CompareOpcodes(const void *, const void *);
+int Profiler_CompareHotSpots(const void *, const void *);
+
+// External data
+extern char *InstructionNames[];
+
+int profile=0;
+
+// Counters updated for every executed instruction: flat arrays indexed by
+// physical address and by operation code. The first index is 1 for the
+// instructions executed in protected mode
+int profilePCCounts[2][MAINMEMORYSIZE];
+int profileOpcodeCounts[2][LAST_INST];
+
+// Program (image) and instruction of the image loaded in every physical address
+int profileImageOfAddress[MAINMEMORYSIZE];
+int profileInstructionOfAddress[MAINMEMORYSIZE];
+
+PROFILER_IMAGE profileImages[PROFILERMAXIMAGES];
+int numberOfProfileImages=0;
+
+// Instructions executed in addresses with no program loaded by the OS
+int profileUnknownCounts[2];
+
+// Opcode and hot-spot entries used to sort the report
+typedef struct {
+	int index;
+	int instruction;
+	int total;
+} PROFILER_ENTRY;
+
+// Called for the --profile option
+void Profiler_Initialize() {
+	int i;
+
+	profile=1;
+	for (i=0; i<MAINMEMORYSIZE; i++)
+		profileImageOfAddress[i]=PROFILER_NOIMAGE;
+}
+
+// Count the instruction that the processor is executing. The physical
+// address is the one the instruction was fetched from
+void Profiler_CountInstruction(int physicalAddress, int operationCode, int protectedMode) {
+	protectedMode=(protectedMode!=0);
+	if (operationCode<0 || operationCode>=LAST_INST)
+		operationCode=NONEXISTING_INST;
+	profilePCCounts[protectedMode][physicalAddress]++;
+	profileOpcodeCounts[protectedMode][operationCode]++;
+}
+
+// Register the program just loaded by OperatingSystem_LoadProgram from the
+// file position programOffset (after the header lines) on initialAddress.
+// The counters of the addresses it overwrites are moved to the program
+// previously loaded in them
+void Profiler_ProgramLoaded(char *executableName, long programOffset, int initialAddress) {
+	int i, image;
+
+	if (!profile)
+		return;
+
+	image=Profiler_ObtainImage(executableName, programOffset);
+	if (image==PROFILER_NOIMAGE)
+		return;
+
+	for (i=0; i<profileImages[image].numberOfInstructions && initialAddress+i<MAINMEMORYSIZE; i++) {
+		Profiler_FoldAddress(initialAddress+i);
+		profileImageOfAddress[initialAddress+i]=image;
+		profileInstructionOfAddress[initialAddress+i]=i;
+	}
+}
+
+// Return the image of a program file, reading the source line of every
+// instruction with the same rules as OperatingSystem_LoadProgram the first
+// time the program is loaded
+int Profiler_ObtainImage(char *executableName, long programOffset) {
+	char lineRead[MAXLINELENGTH];
+	char *token0;
+	int i, lineNumber=0, capacity=0;
+	PROFILER_IMAGE *image;
+	FILE *programFile;
+
+	for (i=0; i<numberOfProfileImages; i++)
+		if (strcmp(profileImages[i].executableName, executableName)==0)
+			return i;
+
+	if (numberOfProfileImages==PROFILERMAXIMAGES)
+		return PROFILER_NOIMAGE;
+	programFile=fopen(executableName, "r");
+	if (programFile==NULL)
+		return PROFILER_NOIMAGE;
+
+	image=&profileImages[numberOfProfileImages];
+	memset(image, 0, sizeof(PROFILER_IMAGE));
+	image->executableName=(char *) malloc((strlen(executableName)+1)*sizeof(char));
+	strcpy(image->executableName, executableName);
+
+	// Header lines (size, priority, ...) already read by the OS
+	while (ftell(programFile)<programOffset && fgets(lineRead, MAXLINELENGTH, programFile)!=NULL)
+		lineNumber++;
+
+	while (fgets(lineRead, MAXLINELENGTH, programFile)!=NULL) {
+		lineNumber++;
+		token0=strtok(lineRead," \n\r\t");
+		if (token0==NULL || token0[0]=='/' || token0[0]=='\n' || token0[0]=='\r')
+			continue;
+		if (image->numberOfInstructions==capacity) {
+			capacity=(capacity==0) ? 32 : 2*capacity;
+			image->sourceLine=(int *) realloc(image->sourceLine, capacity*sizeof(int));
+			image->operationCode=(int *) realloc(image->operationCode, capacity*sizeof(int));
+		}
+		image->sourceLine[image->numberOfInstructions]=lineNumber;
+		image->operationCode[image->numberOfInstructions]=Processor_ToInstruction(token0);
+		image->numberOfInstructions++;
+	}
+	fclose(programFile);
+
+	image->counts=(int *) calloc(image->numberOfInstructions+1, sizeof(int));
+	image->protectedCounts=(int *) calloc(image->numberOfInstructions+1, sizeof(int));
+	return numberOfProfileImages++;
+}
+
+// Move the counters of a physical address to the program loaded in it
+void Profiler_FoldAddress(int address) {
+	int image=profileImageOfAddress[address];
+	int instruction=profileInstructionOfAddress[address];
+
+	if (image==PROFILER_NOIMAGE) {
+		profileUnknownCounts[0]+=profilePCCounts[0][address];
+		profileUnknownCounts[1]+=profilePCCounts[1][address];
+	}
+	else {
+		profileImages[image].counts[instruction]+=profilePCCounts[0][address];
+		profileImages[image].protectedCounts[instruction]+=profilePCCounts[1][address];
+	}
+	profilePCCounts[0][address]=0;
+	profilePCCounts[1][address]=0;
+}
+
+int Profiler_CompareOpcodes(const void *a, const void *b) {
+	const PROFILER_ENTRY *x=a, *y=b;
+	if (x->total!=y->total)
+		return y->total-x->total;
+	return x->index-y->index;
+}
+
+int Profiler_CompareHotSpots(const void *a, const void *b) {
+	const PROFILER_ENTRY *x=a, *y=b;
+	if (x->total!=y->total)
+		return y->total-x->total;
+	if (x->index!=y->index)
+		return x->index-y->index;
+	return x->instruction-y->instruction;
+}
+
+// Show at shutdown the executed instructions per operation code and the
+// program lines that have been executed more times
+void Profiler_PrintReport() {
+	PROFILER_ENTRY opcodes[LAST_INST];
+	PROFILER_ENTRY *hotSpots;
+	PROFILER_IMAGE *image;
+	int i, j, total, numberOfHotSpots=0, totalProtected=0;
+
+	if (!profile)
+		return;
+
+	for (i=0; i<MAINMEMORYSIZE; i++)
+		Profiler_FoldAddress(i);
+
+	for (i=0; i<LAST_INST; i++) {
+		opcodes[i].index=i;
+		opcodes[i].total=profileOpcodeCounts[0][i]+profileOpcodeCounts[1][i];
+		totalProtected+=profileOpcodeCounts[1][i];
+	}
+	qsort(opcodes, LAST_INST, sizeof(PROFILER_ENTRY), Profiler_CompareOpcodes);
+
+	total=totalProtected;
+	for (i=0; i<LAST_INST; i++)
+		total+=profileOpcodeCounts[0][i];
+
+	ComputerSystem_DebugMessage(164,SHUTDOWN,total,totalProtected);
+	for (i=0; i<LAST_INST && opcodes[i].total>0; i++)
+		ComputerSystem_DebugMessage(165,SHUTDOWN,InstructionNames[opcodes[i].index],
+			profileOpcodeCounts[0][opcodes[i].index],profileOpcodeCounts[1][opcodes[i].index]);
+
+	for (i=0; i<numberOfProfileImages; i++)
+		numberOfHotSpots+=profileImages[i].numberOfInstructions;
+	hotSpots=(PROFILER_ENTRY *) malloc((numberOfHotSpots+1)*sizeof(PROFILER_ENTRY));
+	numberOfHotSpots=0;
+	for (i=0; i<numberOfProfileImages; i++)
+		for (j=0; j<profileImages[i].numberOfInstructions; j++)
+			if (profileImages[i].counts[j]+profileImages[i].protectedCounts[j]>0) {
+				hotSpots[numberOfHotSpots].index=i;
+				hotSpots[numberOfHotSpots].instruction=j;
+				hotSpots[numberOfHotSpots].total=profileImages[i].counts[j]+profileImages[i].protectedCounts[j];
+				numberOfHotSpots++;
+			}
+	qsort(hotSpots, numberOfHotSpots, sizeof(PROFILER_ENTRY), Profiler_CompareHotSpots);
+
+	ComputerSystem_DebugMessage(166,SHUTDOWN,numberOfHotSpots<PROFILERHOTSPOTS ? numberOfHotSpots : PROFILERHOTSPOTS);
+	for (i=0; i<numberOfHotSpots && i<PROFILERHOTSPOTS; i++) {
+		image=&profileImages[hotSpots[i].index];
+		j=hotSpots[i].instruction;
+		ComputerSystem_DebugMessage(167,SHUTDOWN,hotSpots[i].total,image->executableName,image->sourceLine[j],
+			InstructionNames[image->operationCode[j]],image->counts[j],image->protectedCounts[j]);
+	}
+	if (profileUnknownCounts[0]+profileUnknownCounts[1]>0)
+		ComputerSystem_DebugMessage(168,SHUTDOWN,profileUnknownCounts[0],profileUnknownCounts[1]);
+	free(hotSpots);
+}
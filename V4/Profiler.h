@@ -0,0 +1,38 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Simulator.h"
+#include "ProcessorBase.h"
+
+// The profiler counts the executed instructions per operation code and per
+// physical address. Every address is mapped back to the program loaded in it
+// and to the line of the program file the instruction was read from
+
+// Maximum number of different programs whose counters are kept
+#define PROFILERMAXIMAGES (PROGRAMSMAXNUMBER+1)
+
+// Number of instructions shown in the hot-spot report
+#define PROFILERHOTSPOTS 20
+
+#define PROFILER_NOIMAGE -1
+
+// Counters of the instructions of a program file
+typedef struct {
+	char *executableName;
+	int numberOfInstructions;
+	int *sourceLine; // Line of the program file of every instruction
+	int *operationCode; // Operation code of every instruction
+	int *counts; // Executions of every instruction in user mode
+	int *protectedCounts; // Executions of every instruction in protected mode
+} PROFILER_IMAGE;
+
+// Functions prototypes
+void Profiler_Initialize();
+void Profiler_CountInstruction(int, int, int);
+void Profiler_ProgramLoaded(char *, long, int);
+void Profiler_PrintReport();
+
+// Set to 1 by the --profile option
+extern int profile;
+
+#endif
@@ -5,6 +5,13 @@
 #include "ComputerSystem.h"
 #include "ComputerSystemBase.h"
 #include "Asserts.h"
+#include "Checkpoint.h"
+#include "OperatingSystem.h"
+#include "Profiler.h"
+#include "Processor.h"
+#include "Device.h"
+#include "DMA.h"
+#include "Cache.h"
 
 // Functions prototypes
 int Simulator_GetOption(char *);
@@ -22,7 +29,27 @@ char *options[]={
 	"--assertsFile",
 	"--debugSections",
 	"--intervalBetweenInterrupts",
+	"--checkpoint",
+	"--restore",
+	"--accounting",
+	"--interruptPriorities",
+	"--mlfq",
+	"--quantum",
+	"--cfs",
+	"--scheduler",
+	"--manifest",
+	"--swap",
+	"--admission",
+	"--ioLatency",
+	"--dmaBurst",
+	"--blockCost",
+	"--iCache",
+	"--dCache",
+	"--missPenalty",
 	"--generateAsserts",
+	"--fastForward",
+	"--profile",
+	"--interruptBatch",
 	"--help",
 	NULL };
 
@@ -33,12 +60,32 @@ char *optionsDefault[]={
 	"asserts",
 	"A",
 	"5",
+	"tick:file",
+	"file",
+	"file.csv",
+	"line,line,...",
+	MLFQDEFAULTOPTION,
+	"0",
+	"2",
+	"priority",
+	"file",
+	"file",
+	"drop",
+	"10",
+	"4",
+	"8",
+	"sets,ways,lineSize[,lru|fifo|random]",
+	"sets,ways,lineSize[,lru|fifo|random]",
+	"4",
+	"No value",
+	"No value",
+	"No value",
 	"No value",
 	"No value",
 	NULL
 };
 
-enum {INITIALPID, ENDSIMULATIONTIME, NUMASSERTS, ASSERTSFILE, DEBUGSECTIONS, INTERVALBETWEENINTERRUPTS, GENERATEASSERTS, HELP};
+enum {INITIALPID, ENDSIMULATIONTIME, NUMASSERTS, ASSERTSFILE, DEBUGSECTIONS, INTERVALBETWEENINTERRUPTS, CHECKPOINT, RESTORE, ACCOUNTING, INTERRUPTPRIORITIES, MLFQ, QUANTUM, CFS, SCHEDULER, MANIFEST, SWAP, ADMISSION, IOLATENCY, DMABURST, BLOCKCOST, ICACHE, DCACHE, MISSPENALTY, GENERATEASSERTS, FASTFORWARD, PROFILE, INTERRUPTBATCH, HELP};
 
 
 int main(int argc, char *argv[]) {
@@ -90,10 +137,83 @@ int main(int argc, char *argv[]) {
 				case GENERATEASSERTS:
 					GEN_ASSERTS=1; 
 					break;
+				case FASTFORWARD:
+					fastForward=1;
+					break;
+				case PROFILE:
+					Profiler_Initialize();
+					break;
+				case INTERRUPTBATCH:
+					interruptBatchMode=1;
+					break;
 				case INTERVALBETWEENINTERRUPTS:
 					if (optionValue==NULL || sscanf(optionValue,"%d",&intervalBetweenInterrupts)==0)
 						intervalBetweenInterrupts=DEFAULT_INTERVAL_BETWEEN_INTERRUPTS;
 					break;
+				case CHECKPOINT:
+					if (Checkpoint_ParseOption(optionValue)==CHECKPOINT_FAIL)
+						printf("Invalid value for option %s, use %s=tick:file\n", option, option);
+					break;
+				case RESTORE:
+					restoreFile=optionValue;
+					break;
+				case ACCOUNTING:
+					accountingFile=optionValue;
+					break;
+				case INTERRUPTPRIORITIES:
+					if (Processor_SetInterruptPriorities(optionValue)==CPU_FAIL)
+						printf("Invalid value for option %s, use %s=line,line,... with lines %d and %d first\n", option, option, SYSCALL_BIT, EXCEPTION_BIT);
+					break;
+				case MLFQ:
+					if (OperatingSystem_ParseMLFQOption(optionValue)==INVALIDOPTION)
+						printf("Invalid value for option %s, use %s=quantum,quantum,...[:aging]\n", option, option);
+					break;
+				case QUANTUM:
+					if (optionValue==NULL || sscanf(optionValue,"%d",&roundRobinQuantum)==0 || roundRobinQuantum<0)
+						roundRobinQuantum=0;
+					break;
+				case CFS:
+					if (optionValue!=NULL && (sscanf(optionValue,"%d",&cfsGranularity)!=1 || cfsGranularity<=0)) {
+						cfsGranularity=CFSDEFAULTGRANULARITY;
+						printf("Invalid value for option %s, use %s=granularity\n", option, option);
+					}
+					schedulingPolicy=SCHEDULER_CFS;
+					break;
+				case SCHEDULER:
+					if (OperatingSystem_SelectScheduler(optionValue)==INVALIDOPTION)
+						printf("Invalid value for option %s, use %s=priority|mlfq|cfs\n", option, option);
+					break;
+				case MANIFEST:
+					manifestFile=optionValue;
+					break;
+				case SWAP:
+					swapFile=optionValue;
+					break;
+				case ADMISSION:
+					if (OperatingSystem_SelectAdmissionPolicy(optionValue)==INVALIDOPTION)
+						printf("Invalid value for option %s, use %s=drop|fifo|smallest|bestfit\n", option, option);
+					break;
+				case IOLATENCY:
+					if (!Device_SetLatency(optionValue))
+						printf("Invalid value for option %s, use %s=tics or %s=inputTics,outputTics\n", option, option, option);
+					break;
+				case DMABURST:
+					if (!DMA_SetBurst(optionValue))
+						printf("Invalid value for option %s, use %s=cells\n", option, option);
+					break;
+				case BLOCKCOST:
+					if (Processor_SetBlockCost(optionValue)==CPU_FAIL)
+						printf("Invalid value for option %s, use %s=cellsPerTic\n", option, option);
+					break;
+				case ICACHE:
+				case DCACHE:
+					if (!Cache_Configure(optionIndex==ICACHE ? INSTRUCTIONCACHE : DATACACHE, optionValue))
+						printf("Invalid value for option %s, use %s=sets,ways,lineSize[,lru|fifo|random]\n", option, option);
+					break;
+				case MISSPENALTY:
+					if (!Cache_SetMissPenalty(optionValue))
+						printf("Invalid value for option %s, use %s=tics\n", option, option);
+					break;
 				case HELP:
 					{
 						int j;
@@ -131,7 +251,16 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
-	if ((numPrograms<=0) || (numPrograms>PROGRAMSMAXNUMBER)) {
+	// When restoring a checkpoint, the program list is the one saved in it
+	if (restoreFile!=NULL) {
+		if (numPrograms!=0) {
+			printf("USE: Simulator [--optionX=optionXValue ...] --restore=file\n");
+			printf("Program names are not allowed when restoring a checkpoint !!!\n");
+			exit(-1);
+		}
+	}
+	// With a manifest, the command line programs are optional
+	else if ((numPrograms<0) || (numPrograms==0 && manifestFile==NULL) || (numPrograms>PROGRAMSMAXNUMBER)) {
 		printf("USE: Simulator [--optionX=optionXValue ...] <program1> [arrivalTime] [<program2> [arrivalTime] .... <program%d [arrivalTime]] \n",PROGRAMSMAXNUMBER);
 		if (numPrograms<0)
 			printf("Options must be before program names !!!\n");
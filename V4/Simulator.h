@@ -11,7 +11,10 @@
 
 #define PROCESSTABLEMAXSIZE 4
 
-// Main memory size (number of memory cells)
+// Main memory size (number of memory cells). Can be given when compiling, but
+// addresses over 2047 can only be used in the instructions with -DWIDECELLS
+#ifndef MAINMEMORYSIZE
 #define MAINMEMORYSIZE 300
+#endif
 
 #endif
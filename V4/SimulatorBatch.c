@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include "SimulatorBatch.h"
+
+// Runs the scenarios of a manifest file across a pool of simulator processes.
+// Every scenario runs in its own process, so the simulated machine of a
+// scenario never shares state with the others. Its output is saved in
+// outputDir/scenarioName.log and its exit code and time in outputDir/summary.csv.
+// The files the simulator writes (--swap, --checkpoint and --accounting options)
+// go to outputDir/scenarioName/ when they are given with a relative path
+
+// Functions prototypes
+int SimulatorBatch_GetOption(char *);
+int SimulatorBatch_ReadManifest(char *);
+void SimulatorBatch_RunScenarios();
+int SimulatorBatch_LaunchScenario(int);
+int SimulatorBatch_WaitScenario();
+int SimulatorBatch_PrintSummary();
+int SimulatorBatch_CountWords(char *);
+char *SimulatorBatch_ScenarioFile(int, char *);
+double SimulatorBatch_Now();
+
+char *options[]={
+	"--workers",
+	"--simulator",
+	"--outputDir",
+	"--help",
+	NULL };
+
+char *optionsDefault[]={
+	"Number of host cores",
+	BATCH_DEFAULT_SIMULATOR,
+	BATCH_DEFAULT_OUTPUTDIR,
+	"No value",
+	NULL
+};
+
+enum {WORKERS, SIMULATOR, OUTPUTDIR, HELP};
+
+int numberOfWorkers=0;
+// Simulator options whose value is a file written by the simulator. The
+// file name of --checkpoint goes after the tick and a colon
+char *outputFileOptions[]={"--swap", "--checkpoint", "--accounting", NULL};
+
+char *simulatorPath=BATCH_DEFAULT_SIMULATOR;
+char *outputDir=BATCH_DEFAULT_OUTPUTDIR;
+
+// Scenarios read from the manifest, in the same order
+BATCH_SCENARIO *scenarios=NULL;
+int numberOfScenarios=0;
+
+// Manifest lines not run because they are illegal, too long or have too many words
+int numberOfIllegalScenarios=0;
+
+
+int main(int argc, char *argv[]) {
+
+	int i, isOption=1;
+	char *option, *optionValue;
+
+	for (i=1; i < argc && isOption ;) {
+		if (argv[i][0]=='-' && argv[i][1]=='-') {
+			option=strtok(argv[i],"=");
+			optionValue=strtok(NULL," ");
+			switch (SimulatorBatch_GetOption(option)) {
+				case WORKERS:
+					if (optionValue==NULL || sscanf(optionValue,"%d",&numberOfWorkers)==0)
+						numberOfWorkers=0;
+					break;
+				case SIMULATOR:
+					if (optionValue!=NULL)
+						simulatorPath=optionValue;
+					break;
+				case OUTPUTDIR:
+					if (optionValue!=NULL)
+						outputDir=optionValue;
+					break;
+				case HELP:
+					{
+						int j;
+						printf("Use one or more of these options:\n");
+						for (j=0; options[j]!=NULL; j++)
+							if (j<HELP)
+								printf("\t%s=ValueOfOption  [%s]\n",options[j], optionsDefault[j]);
+							else
+								printf("\t%s\n",options[j]);
+					}
+					break;
+				default :
+					printf("Invalid option: %s\n", option);
+					break;
+			}
+			i++;
+		}
+		else isOption=0;
+	}
+
+	if (i!=argc-1) {
+		printf("USE: SimulatorBatch [--optionX=optionXValue ...] <manifestFile>\n");
+		printf("Each manifest line is: scenarioName,[--optionX=optionXValue ...] <program1> [arrivalTime] ...\n");
+		exit(-1);
+	}
+
+	if (SimulatorBatch_ReadManifest(argv[i])<=0) {
+		printf("No scenarios in manifest file %s !!!\n", argv[i]);
+		exit(-1);
+	}
+
+	// By default, one simulator per host core
+	if (numberOfWorkers<=0)
+		numberOfWorkers=(int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (numberOfWorkers<=0)
+		numberOfWorkers=1;
+	if (numberOfWorkers>BATCHMAXWORKERS)
+		numberOfWorkers=BATCHMAXWORKERS;
+
+	if (mkdir(outputDir,0755)!=0 && access(outputDir,W_OK)!=0) {
+		printf("Output directory %s is not available !!!\n", outputDir);
+		exit(-1);
+	}
+
+	SimulatorBatch_RunScenarios();
+
+	// Only a batch in which all the scenarios finish correctly is successful
+	return SimulatorBatch_PrintSummary();
+}
+
+int SimulatorBatch_GetOption(char *option){
+	int i;
+	for (i=0; options[i]!=NULL ; i++)
+		if (strcasecmp(options[i],option)==0)
+			return i;
+	return -1;
+}
+
+// Fill in the scenarios array with the lines of the manifest file
+// Return the number of scenarios read, or -1 if the file does not exist
+int SimulatorBatch_ReadManifest(char *manifestName) {
+	FILE *manifestFile;
+	char lineRead[BATCHMAXLINELENGTH];
+	char *name, *arguments;
+	int capacity=0, tooLong, c;
+
+	manifestFile=fopen(manifestName, "r");
+	if (manifestFile==NULL)
+		return -1;
+
+	while (fgets(lineRead, BATCHMAXLINELENGTH, manifestFile) != NULL) {
+		// A line that does not fit in lineRead is discarded up to its end
+		tooLong=strchr(lineRead,'\n')==NULL && !feof(manifestFile);
+		if (tooLong)
+			while ((c=fgetc(manifestFile))!=EOF && c!='\n');
+
+		// Skip comments and empty lines
+		if (lineRead[0]=='/' || lineRead[0]=='\n' || lineRead[0]=='\r')
+			continue;
+
+		if (tooLong) {
+			printf("Scenario longer than %d characters in manifest file %s: %.*s...\n",
+				BATCHMAXLINELENGTH-2, manifestName, BATCHMAXNAMELENGTH, lineRead);
+			numberOfIllegalScenarios++;
+			continue;
+		}
+
+		name=strtok(lineRead,",");
+		arguments=strtok(NULL,"\n\r");
+		if (name==NULL || arguments==NULL) {
+			printf("Illegal scenario in manifest file %s: %s\n", manifestName, lineRead);
+			numberOfIllegalScenarios++;
+			continue;
+		}
+
+		if (SimulatorBatch_CountWords(arguments)>BATCHMAXARGS) {
+			printf("Scenario %s has more than %d arguments in manifest file %s\n", name, BATCHMAXARGS, manifestName);
+			numberOfIllegalScenarios++;
+			continue;
+		}
+
+		if (numberOfScenarios==capacity) {
+			capacity=(capacity==0) ? 64 : 2*capacity;
+			scenarios=(BATCH_SCENARIO *) realloc(scenarios, capacity*sizeof(BATCH_SCENARIO));
+		}
+		strncpy(scenarios[numberOfScenarios].name, name, BATCHMAXNAMELENGTH-1);
+		scenarios[numberOfScenarios].name[BATCHMAXNAMELENGTH-1]=0;
+		scenarios[numberOfScenarios].arguments=(char *) malloc((strlen(arguments)+1)*sizeof(char));
+		strcpy(scenarios[numberOfScenarios].arguments, arguments);
+		scenarios[numberOfScenarios].pid=0;
+		scenarios[numberOfScenarios].exitCode=BATCH_NOTLAUNCHED;
+		scenarios[numberOfScenarios].startTime=0;
+		scenarios[numberOfScenarios].elapsedTime=0;
+		numberOfScenarios++;
+	}
+	fclose(manifestFile);
+	return numberOfScenarios;
+}
+
+// Keep numberOfWorkers simulators running until all scenarios have finished
+void SimulatorBatch_RunScenarios() {
+	int nextScenario=0, running=0;
+
+	while (nextScenario<numberOfScenarios || running>0) {
+		if (nextScenario<numberOfScenarios && running<numberOfWorkers) {
+			if (SimulatorBatch_LaunchScenario(nextScenario++)>0)
+				running++;
+		}
+		else
+			switch (SimulatorBatch_WaitScenario()) {
+				case BATCH_NOSIMULATORS:
+					running=0; // No more simulators to wait for
+					break;
+				case BATCH_UNKNOWNSIMULATOR:
+					break;
+				default:
+					running--;
+			}
+	}
+}
+
+// Start a simulator for a scenario, sending its output to outputDir/scenarioName.log
+// Return the PID of the simulator process, or -1 if it can not be started
+int SimulatorBatch_LaunchScenario(int scenario) {
+	char *argv[BATCHMAXARGS+2];
+	char logName[BATCHMAXLINELENGTH];
+	char *word;
+	int argc=0, logFile;
+	pid_t pid;
+
+	fflush(stdout);
+	scenarios[scenario].startTime=SimulatorBatch_Now();
+	pid=fork();
+	if (pid<0)
+		return -1;
+	if (pid>0) {
+		scenarios[scenario].pid=pid;
+		return pid;
+	}
+
+	// Child process: the simulator of the scenario
+	snprintf(logName, BATCHMAXLINELENGTH, "%s/%s.log", outputDir, scenarios[scenario].name);
+	logFile=open(logName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (logFile<0)
+		_exit(BATCH_NOTLAUNCHED);
+	dup2(logFile, STDOUT_FILENO);
+	dup2(logFile, STDERR_FILENO);
+	close(logFile);
+
+	argv[argc++]=simulatorPath;
+	for (word=strtok(scenarios[scenario].arguments," \t"); word!=NULL && argc<=BATCHMAXARGS; word=strtok(NULL," \t"))
+		argv[argc++]=SimulatorBatch_ScenarioFile(scenario, word);
+	argv[argc]=NULL;
+
+	execv(simulatorPath, argv);
+	printf("Simulator %s can not be executed\n", simulatorPath);
+	_exit(BATCH_NOTLAUNCHED);
+}
+
+// Wait for any running simulator and store its exit code and time
+// Return the index of the finished scenario, BATCH_NOSIMULATORS if there are no
+// more child processes or BATCH_UNKNOWNSIMULATOR if the process is not a scenario
+int SimulatorBatch_WaitScenario() {
+	int i, status;
+	pid_t pid;
+
+	do {
+		errno=0;
+		pid=wait(&status);
+	} while (pid<0 && errno==EINTR);
+
+	if (pid<0)
+		return errno==ECHILD ? BATCH_NOSIMULATORS : BATCH_UNKNOWNSIMULATOR;
+
+	for (i=0; i<numberOfScenarios; i++)
+		if (scenarios[i].pid==pid) {
+			scenarios[i].elapsedTime=SimulatorBatch_Now()-scenarios[i].startTime;
+			if (WIFEXITED(status))
+				scenarios[i].exitCode=WEXITSTATUS(status);
+			else
+				scenarios[i].exitCode=128+WTERMSIG(status); // Same code as the shell
+			return i;
+		}
+	return BATCH_UNKNOWNSIMULATOR;
+}
+
+// Show the result of every scenario and save it in outputDir/summary.csv
+// Return 0 if all the scenarios have finished with exit code 0 and none was
+// illegal, 1 else
+int SimulatorBatch_PrintSummary() {
+	char summaryName[BATCHMAXLINELENGTH];
+	FILE *summaryFile;
+	int i, failed=0;
+	double totalTime=0;
+
+	snprintf(summaryName, BATCHMAXLINELENGTH, "%s/%s", outputDir, BATCH_SUMMARY_FILE);
+	summaryFile=fopen(summaryName, "w");
+	if (summaryFile!=NULL)
+		fprintf(summaryFile, "scenario,exitCode,seconds\n");
+
+	for (i=0; i<numberOfScenarios; i++) {
+		printf("[%s] exit code %d in %.3f seconds\n", scenarios[i].name, scenarios[i].exitCode, scenarios[i].elapsedTime);
+		if (summaryFile!=NULL)
+			fprintf(summaryFile, "%s,%d,%.6f\n", scenarios[i].name, scenarios[i].exitCode, scenarios[i].elapsedTime);
+		if (scenarios[i].exitCode!=0)
+			failed++;
+		totalTime+=scenarios[i].elapsedTime;
+	}
+	if (summaryFile!=NULL)
+		fclose(summaryFile);
+
+	printf("%d scenarios (%d failed) with %d workers, %.3f simulator seconds. Summary in %s\n",
+		numberOfScenarios, failed, numberOfWorkers, totalTime, summaryName);
+	if (numberOfIllegalScenarios>0)
+		printf("%d illegal scenarios in the manifest have not been run\n", numberOfIllegalScenarios);
+
+	return failed>0 || numberOfIllegalScenarios>0;
+}
+
+// Number of words separated by blanks in a string
+int SimulatorBatch_CountWords(char *string) {
+	int words=0, inWord=0;
+
+	for (; *string!=0; string++)
+		if (*string==' ' || *string=='\t')
+			inWord=0;
+		else if (!inWord) {
+			inWord=1;
+			words++;
+		}
+	return words;
+}
+
+// Return a simulator argument in which a relative file of an option in
+// outputFileOptions is moved to outputDir/scenarioName/, so the scenarios
+// running at the same time do not overwrite each other's files. The rest
+// of the arguments are returned unchanged
+char *SimulatorBatch_ScenarioFile(int scenario, char *word) {
+	char directory[BATCHMAXLINELENGTH];
+	char *file, *newWord;
+	int i, length;
+
+	for (i=0; outputFileOptions[i]!=NULL; i++) {
+		length=strlen(outputFileOptions[i]);
+		if (strncasecmp(word, outputFileOptions[i], length)==0 && word[length]=='=')
+			break;
+	}
+	if (outputFileOptions[i]==NULL)
+		return word;
+	file=word+length+1;
+	if (strchr(file,':')!=NULL)
+		file=strchr(file,':')+1;
+	if (file[0]==0 || file[0]=='/')
+		return word;
+
+	snprintf(directory, BATCHMAXLINELENGTH, "%s/%s", outputDir, scenarios[scenario].name);
+	mkdir(directory, 0755);
+	newWord=(char *) malloc((strlen(word)+strlen(directory)+2)*sizeof(char));
+	sprintf(newWord, "%.*s%s/%s", (int) (file-word), word, directory, file);
+	return newWord;
+}
+
+// Host wall clock time in seconds
+double SimulatorBatch_Now() {
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return now.tv_sec+now.tv_usec/1000000.0;
+}
@@ -0,0 +1,44 @@
+#ifndef SIMULATORBATCH_H
+#define SIMULATORBATCH_H
+
+#include "Simulator.h"
+#include <sys/types.h>
+
+// General constants for the batch runner
+
+// Maximum number of words (options, programs and arrival times) in a scenario line
+#define BATCHMAXARGS (2*PROGRAMSMAXNUMBER+16)
+
+// Maximum number of simulators running at the same time
+#define BATCHMAXWORKERS 256
+
+// Maximum length of a manifest line
+#define BATCHMAXLINELENGTH 1024
+
+// Maximum length of a scenario name
+#define BATCHMAXNAMELENGTH 64
+
+// Default values for the batch runner options
+#define BATCH_DEFAULT_SIMULATOR "./Simulator"
+#define BATCH_DEFAULT_OUTPUTDIR "batchOutput"
+#define BATCH_SUMMARY_FILE "summary.csv"
+
+// Exit code stored for a scenario whose simulator could not be launched
+#define BATCH_NOTLAUNCHED 127
+
+// Results of waiting for a simulator that are not the index of a scenario
+#define BATCH_NOSIMULATORS -1
+#define BATCH_UNKNOWNSIMULATOR -2
+
+// A scenario is a line of the manifest file:
+//		scenarioName,[--optionX=optionXValue ...] <program1> [arrivalTime] [<program2> [arrivalTime] ...]
+typedef struct {
+	char name[BATCHMAXNAMELENGTH];
+	char *arguments; // Rest of the manifest line, split later into the simulator argv
+	pid_t pid; // Process running the simulator, 0 if not launched yet
+	int exitCode;
+	double startTime;
+	double elapsedTime;
+} BATCH_SCENARIO;
+
+#endif